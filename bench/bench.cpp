@@ -0,0 +1,140 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include "bench/json.h"
+
+void BenchRunner::summarize(BenchResult& result)
+{
+    List<double> sorted = result.samples;
+    std::sort(sorted.begin(), sorted.end());
+    std::size_t count = sorted.size();
+    if (count == 0)
+        return;
+    result.median = count % 2 == 1 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+    result.min = sorted.front();
+    result.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / count;
+}
+
+void writeResults(std::ostream& out, const BenchConfig& config, const List<BenchResult>& results)
+{
+    std::streamsize precision = out.precision();
+    out << "{\n  \"seed\": " << config.seed << ",\n  \"warmup\": " << config.warmup << ",\n  \"reps\": "
+        << config.reps << ",\n  \"unit\": \"ns/op\",\n  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        writeJsonString(out, result.name);
+        out << ", \"n\": " << result.n << ", \"density\": " << std::setprecision(15) << result.density
+            << ", \"ops\": " << result.ops << std::setprecision(10) << ", \"median\": " << result.median
+            << ", \"min\": " << result.min << ", \"mean\": " << result.mean << ", \"samples\": [";
+        for (std::size_t s = 0; s < result.samples.size(); ++s)
+            out << (s == 0 ? "" : ", ") << result.samples[s];
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+    out.precision(precision);
+}
+
+namespace
+{
+
+// Числовое поле случая; std::runtime_error, если его нет
+double numberField(const JsonValue& entry, const std::string& key)
+{
+    const JsonValue* value = entry.find(key);
+    if (value == nullptr || value->type != JsonValue::kNumber)
+        throw std::runtime_error("benchmark entry without numeric field " + key);
+    return value->number;
+}
+
+bool sameCase(const BenchResult& lhs, const BenchResult& rhs)
+{
+    // плотность прошла через текст, поэтому сравнивается с допуском
+    return lhs.name == rhs.name && lhs.n == rhs.n
+        && std::fabs(lhs.density - rhs.density) <= 1e-9 * std::max(1.0, std::fabs(lhs.density));
+}
+
+} // namespace
+
+List<BenchResult> readResults(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Error opening file " + path);
+    std::stringstream text;
+    text << in.rdbuf();
+
+    JsonValue root = parseJson(text.str());
+    const JsonValue* entries = root.find("results");
+    if (entries == nullptr || entries->type != JsonValue::kArray)
+        throw std::runtime_error("Not a benchmark file: " + path);
+
+    List<BenchResult> results;
+    for (const JsonValue& entry : entries->items)
+    {
+        const JsonValue* name = entry.find("name");
+        if (name == nullptr || name->type != JsonValue::kString)
+            throw std::runtime_error("benchmark entry without name in " + path);
+        BenchResult result;
+        result.name = name->string;
+        result.n = static_cast<uint32_t>(numberField(entry, "n"));
+        result.density = numberField(entry, "density");
+        result.ops = static_cast<uint64_t>(numberField(entry, "ops"));
+        result.median = numberField(entry, "median");
+        result.min = numberField(entry, "min");
+        result.mean = numberField(entry, "mean");
+        if (const JsonValue* samples = entry.find("samples"))
+            for (const JsonValue& sample : samples->items)
+                result.samples.push_back(sample.number);
+        results.push_back(std::move(result));
+    }
+    return results;
+}
+
+std::size_t compareResults(const List<BenchResult>& current, const List<BenchResult>& baseline, double threshold,
+                           std::ostream& report)
+{
+    std::size_t regressions = 0;
+    report << std::left << std::setw(20) << "case" << std::right << std::setw(10) << "n" << std::setw(10)
+           << "density" << std::setw(14) << "base ns/op" << std::setw(14) << "ns/op" << std::setw(9) << "ratio"
+           << "\n";
+    List<bool> matched(baseline.size(), false);
+    for (const BenchResult& result : current)
+    {
+        auto base = std::find_if(baseline.begin(), baseline.end(),
+                                 [&result](const BenchResult& other) { return sameCase(result, other); });
+        if (base == baseline.end())
+        {
+            report << std::left << std::setw(20) << result.name << std::right << std::setw(10) << result.n
+                   << std::setw(10) << result.density << "  (no baseline)\n";
+            continue;
+        }
+        matched[base - baseline.begin()] = true;
+        double ratio = base->median > 0 ? result.median / base->median : 1;
+        report << std::left << std::setw(20) << result.name << std::right << std::setw(10) << result.n
+               << std::setw(10) << result.density << std::fixed << std::setprecision(1) << std::setw(14)
+               << base->median << std::setw(14) << result.median << std::setprecision(3) << std::setw(9) << ratio
+               << std::defaultfloat << std::setprecision(6);
+        if (ratio > 1 + threshold)
+        {
+            report << "  REGRESSION";
+            ++regressions;
+        }
+        else if (ratio < 1 - threshold)
+            report << "  faster";
+        report << "\n";
+    }
+    for (std::size_t i = 0; i < baseline.size(); ++i)
+        if (!matched[i])
+            report << std::left << std::setw(20) << baseline[i].name << std::right << std::setw(10) << baseline[i].n
+                   << std::setw(10) << baseline[i].density << "  (missing in this run)\n";
+    return regressions;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "common/common.h"
+
+// Замер одного случая: этап конвейера на графе с n вершинами и плотностью density
+struct BenchResult
+{
+    std::string name;      // Этап (prufer_gen, bfs, density_inverse, ...)
+    uint32_t n = 0;
+    double density = 0;    // 0 для этапов, не зависящих от плотности
+    uint64_t ops = 1;      // Операций за повтор (например, поисков); время -- в нс на операцию
+    double median = 0;
+    double min = 0;
+    double mean = 0;
+    List<double> samples;  // Время каждого повтора, нс на операцию
+};
+
+// Настройки прогона, записываемые в файл вместе с результатами
+struct BenchConfig
+{
+    uint64_t seed = 1;     // Затравка: входные данные всех повторов одинаковы
+    int warmup = 1;        // Незамеряемых повторов перед замерами
+    int reps = 5;          // Замеряемых повторов
+};
+
+/**
+ * Прогон случаев: каждый повтор готовит данные (без замера) и замеряет тело.
+ *
+ * @details
+ *      Тело возвращает число, зависящее от результата работы (размер, сумму), -- оно копится
+ *      в m_sink, чтобы компилятор не выбросил вычисления. По повторам считаются медиана,
+ *      минимум и среднее; для сравнения с базовым файлом используется медиана.
+ */
+class BenchRunner
+{
+public:
+    explicit BenchRunner(const BenchConfig& config) : m_config(config) {}
+
+    /**
+     * @param setup готовит входные данные повтора (время не учитывается)
+     * @param body замеряемая часть; возвращает uint64_t, зависящий от результата
+     */
+    template<class Setup, class Body>
+    BenchResult run(const std::string& name, uint32_t n, double density, uint64_t ops, Setup&& setup, Body&& body)
+    {
+        using Clock = std::chrono::steady_clock;
+        BenchResult result;
+        result.name = name;
+        result.n = n;
+        result.density = density;
+        result.ops = ops;
+        for (int rep = 0; rep < m_config.warmup + m_config.reps; ++rep)
+        {
+            setup();
+            Clock::time_point begin = Clock::now();
+            m_sink += body();
+            double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+            if (rep >= m_config.warmup)
+                result.samples.push_back(elapsed / ops);
+        }
+        summarize(result);
+        return result;
+    }
+
+    const BenchConfig& config() const { return m_config; }
+
+    // Накопленные значения тел (печатаются, чтобы результат работы был наблюдаем)
+    uint64_t sink() const { return m_sink; }
+
+private:
+    static void summarize(BenchResult& result);
+
+    BenchConfig m_config;
+    uint64_t m_sink = 0;
+};
+
+// Запись результатов в JSON: {"seed": .., "warmup": .., "reps": .., "results": [{...}, ...]}
+void writeResults(std::ostream& out, const BenchConfig& config, const List<BenchResult>& results);
+
+/**
+ * Чтение результатов из файла writeResults
+ *
+ * @throw std::runtime_error если файл не открывается или не подходит по формату
+ */
+List<BenchResult> readResults(const std::string& path);
+
+/**
+ * Сравнение с базовым прогоном по медианам случаев с одинаковыми (name, n, density)
+ *
+ * @details
+ *      Для каждого случая печатается отношение текущей медианы к базовой; отношение больше
+ *      1 + threshold отмечается как регрессия, меньше 1 - threshold -- как ускорение.
+ *      Случаи, которых нет в одном из прогонов, перечисляются отдельно.
+ *
+ * @return число регрессий
+ */
+std::size_t compareResults(const List<BenchResult>& current, const List<BenchResult>& baseline, double threshold,
+                           std::ostream& report);
+
+#endif // BENCH_H
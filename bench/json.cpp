@@ -0,0 +1,209 @@
+#include "json.h"
+
+#include <cstdlib>
+#include <stdexcept>
+
+namespace
+{
+
+// Рекурсивный спуск по тексту; m_pos -- текущая позиция
+class JsonParser
+{
+public:
+    explicit JsonParser(const std::string& text) : m_text(text) {}
+
+    JsonValue parseDocument()
+    {
+        JsonValue value = parseValue();
+        skipSpace();
+        if (m_pos != m_text.size())
+            fail("trailing characters");
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& what) const
+    {
+        throw std::runtime_error("JSON error at " + std::to_string(m_pos) + ": " + what);
+    }
+
+    void skipSpace()
+    {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' || m_text[m_pos] == '\r'
+                                          || m_text[m_pos] == '\t'))
+            ++m_pos;
+    }
+
+    // Пропускает пробелы и ожидаемый символ
+    void expect(char c)
+    {
+        skipSpace();
+        if (m_pos >= m_text.size() || m_text[m_pos] != c)
+            fail(std::string("expected '") + c + "'");
+        ++m_pos;
+    }
+
+    // Пропускает пробелы; true и сдвиг, если дальше идёт символ c
+    bool consume(char c)
+    {
+        skipSpace();
+        if (m_pos < m_text.size() && m_text[m_pos] == c)
+        {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeWord(const char* word)
+    {
+        std::size_t length = std::char_traits<char>::length(word);
+        if (m_text.compare(m_pos, length, word) != 0)
+            return false;
+        m_pos += length;
+        return true;
+    }
+
+    JsonValue parseValue()
+    {
+        skipSpace();
+        if (m_pos >= m_text.size())
+            fail("unexpected end");
+        JsonValue value;
+        char c = m_text[m_pos];
+        if (c == '{')
+        {
+            ++m_pos;
+            value.type = JsonValue::kObject;
+            if (consume('}'))
+                return value;
+            do
+            {
+                skipSpace();
+                std::string key = parseString();
+                expect(':');
+                value.members.emplace_back(std::move(key), parseValue());
+            } while (consume(','));
+            expect('}');
+        }
+        else if (c == '[')
+        {
+            ++m_pos;
+            value.type = JsonValue::kArray;
+            if (consume(']'))
+                return value;
+            do
+                value.items.push_back(parseValue());
+            while (consume(','));
+            expect(']');
+        }
+        else if (c == '"')
+        {
+            value.type = JsonValue::kString;
+            value.string = parseString();
+        }
+        else if (consumeWord("true"))
+        {
+            value.type = JsonValue::kBool;
+            value.boolean = true;
+        }
+        else if (consumeWord("false"))
+            value.type = JsonValue::kBool;
+        else if (consumeWord("null"))
+            value.type = JsonValue::kNull;
+        else
+        {
+            const char* begin = m_text.c_str() + m_pos;
+            char* end = nullptr;
+            value.type = JsonValue::kNumber;
+            value.number = std::strtod(begin, &end);
+            if (end == begin)
+                fail("unexpected character");
+            m_pos += end - begin;
+        }
+        return value;
+    }
+
+    std::string parseString()
+    {
+        if (m_pos >= m_text.size() || m_text[m_pos] != '"')
+            fail("expected string");
+        ++m_pos;
+        std::string result;
+        while (true)
+        {
+            if (m_pos >= m_text.size())
+                fail("unterminated string");
+            char c = m_text[m_pos++];
+            if (c == '"')
+                return result;
+            if (c != '\\')
+            {
+                result += c;
+                continue;
+            }
+            if (m_pos >= m_text.size())
+                fail("unterminated string");
+            char escape = m_text[m_pos++];
+            switch (escape)
+            {
+            case '"': case '\\': case '/': result += escape; break;
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'n': result += '\n'; break;
+            case 'r': result += '\r'; break;
+            case 't': result += '\t'; break;
+            case 'u':
+            {
+                if (m_pos + 4 > m_text.size())
+                    fail("bad escape");
+                unsigned long code = std::strtoul(m_text.substr(m_pos, 4).c_str(), nullptr, 16);
+                if (code > 0x7f)
+                    fail("non-ASCII \\u escape");
+                result += static_cast<char>(code);
+                m_pos += 4;
+                break;
+            }
+            default:
+                fail("bad escape");
+            }
+        }
+    }
+
+    const std::string& m_text;
+    std::size_t m_pos = 0;
+};
+
+} // namespace
+
+const JsonValue* JsonValue::find(const std::string& key) const
+{
+    if (type != kObject)
+        return nullptr;
+    for (const auto& member : members)
+        if (member.first == key)
+            return &member.second;
+    return nullptr;
+}
+
+JsonValue parseJson(const std::string& text)
+{
+    return JsonParser(text).parseDocument();
+}
+
+void writeJsonString(std::ostream& out, const std::string& value)
+{
+    out << '"';
+    for (char c : value)
+    {
+        switch (c)
+        {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\t': out << "\\t"; break;
+        default: out << c;
+        }
+    }
+    out << '"';
+}
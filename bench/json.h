@@ -0,0 +1,52 @@
+#pragma once
+#ifndef JSON_H
+#define JSON_H
+
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "common/common.h"
+
+/**
+ * Минимальное дерево JSON для чтения сохранённых файлов замеров.
+ *
+ * @details
+ *      Поддерживаются объекты, массивы, строки, числа, true, false и null. В строках понимаются
+ *      экранирования \" \\ \/ \b \f \n \r \t; \uXXXX -- только для символов ASCII (остальные
+ *      в файлах замеров не встречаются). Порядок полей объекта сохраняется.
+ */
+struct JsonValue
+{
+    enum Type
+    {
+        kNull,
+        kBool,
+        kNumber,
+        kString,
+        kArray,
+        kObject
+    };
+
+    Type type = kNull;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    List<JsonValue> items;                              // Элементы массива
+    List<std::pair<std::string, JsonValue>> members;    // Поля объекта
+
+    // Поле объекта по имени; nullptr, если его нет или значение не объект
+    const JsonValue* find(const std::string& key) const;
+};
+
+/**
+ * Разбирает текст JSON
+ *
+ * @throw std::runtime_error при синтаксической ошибке (с позицией в тексте)
+ */
+JsonValue parseJson(const std::string& text);
+
+// Записывает строку в кавычках с экранированием
+void writeJsonString(std::ostream& out, const std::string& value);
+
+#endif // JSON_H
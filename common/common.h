@@ -4,6 +4,8 @@
 
 #include <vector>
 #include <cstdint>
+#include <limits>
+#include <stdexcept>
 #include <unordered_set>
 #include <unordered_map>
 #include <cstdint>
@@ -20,26 +22,64 @@ using Map = std::unordered_map<T, V>;
 template <class T>
 using List = std::vector<T>;
 
+// Номер вершины. Графы, у которых номера (и фиктивная вершина n в обходах) помещаются в 16 бит,
+// хранят смежность в SizeType -- вдвое компактнее; для больших графов используется WideSizeType.
+// Графы, генераторы и обходы -- шаблоны по типу номера, тип выбирается по n (dispatchIndex)
 using SizeType = uint16_t;
+using WideSizeType = uint32_t;
+
+// смещение в массиве смежности: рёбер бывает больше, чем вершин, поэтому тип шире SizeType
+using OffsetType = uint64_t;
+
+/**
+ * Вызывает run(Index{}) с наименьшим типом номера вершины, достаточным для графа на n вершинах
+ *
+ * @throw std::out_of_range если n не помещается и в WideSizeType
+ */
+template<class Run>
+auto dispatchIndex(uint64_t n, Run&& run)
+{
+    if (n <= std::numeric_limits<SizeType>::max())
+        return run(SizeType{});
+    if (n <= std::numeric_limits<WideSizeType>::max())
+        return run(WideSizeType{});
+    throw std::out_of_range("too many vertices");
+}
 
 // ребро кодируем как пару индексов
-struct EdgeType
+template<class Index>
+struct BasicEdge
 {
-    SizeType first;
-    SizeType second;
+    Index first;
+    Index second;
 };
 
+using EdgeType = BasicEdge<SizeType>;
+
+// рёбра упорядочиваем лексикографически: (first, second)
+template<class Index>
+inline bool operator<(const BasicEdge<Index> &lhs, const BasicEdge<Index> &rhs)
+{
+    return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+}
+
+template<class Index>
+inline bool operator==(const BasicEdge<Index> &lhs, const BasicEdge<Index> &rhs)
+{
+    return lhs.first == rhs.first && lhs.second == rhs.second;
+}
+
 namespace std {
-    template<>
-    struct hash<EdgeType> {
-        size_t operator()(const EdgeType &edge) const {
-            return std::hash<SizeType>()(edge.first) ^ (std::hash<SizeType>()(edge.second) << 1);
+    template<class Index>
+    struct hash<BasicEdge<Index>> {
+        size_t operator()(const BasicEdge<Index> &edge) const {
+            return std::hash<Index>()(edge.first) ^ (std::hash<Index>()(edge.second) << 1);
         }
     };
 
-    template<>
-    struct equal_to<EdgeType> {
-        bool operator()(const EdgeType &first, const EdgeType &second) const {
+    template<class Index>
+    struct equal_to<BasicEdge<Index>> {
+        bool operator()(const BasicEdge<Index> &first, const BasicEdge<Index> &second) const {
             return first.first == second.first && first.second == second.second;
         }
     };
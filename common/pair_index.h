@@ -0,0 +1,146 @@
+#pragma once
+#ifndef PAIR_INDEX_H
+#define PAIR_INDEX_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "common.h"
+
+/**
+ * Номера пар вершин (a, b), a < b, в порядке обхода верхнего треугольника по строкам.
+ *
+ * @details
+ *      Перед строкой a идут (n - 1) + (n - 2) + ... + (n - a) пар. Все вычисления точные
+ *      в uint64_t: произведения делятся на 2 через чётный множитель, а корень при обратном
+ *      преобразовании -- целочисленный (isqrt), так что номера корректны для любого n,
+ *      помещающегося в WideSizeType, а не только пока число пар влезает в SizeType.
+ */
+namespace pair_index
+{
+
+// Целая часть квадратного корня: оценка в double уточняется целочисленной проверкой
+inline uint64_t isqrt(uint64_t x)
+{
+    const uint64_t maxRoot = 0xFFFFFFFFu; //< корень любого uint64_t меньше 2^32
+    uint64_t r = static_cast<uint64_t>(std::sqrt(static_cast<double>(x)));
+    while (r > maxRoot || (r > 0 && r * r > x))
+        --r;
+    while (r < maxRoot && (r + 1) * (r + 1) <= x)
+        ++r;
+    return r;
+}
+
+// r (r + 1) / 2 без переполнения промежуточного произведения
+inline uint64_t triangle(uint64_t r)
+{
+    return r % 2 == 0 ? r / 2 * (r + 1) : (r + 1) / 2 * r;
+}
+
+// Число пар на n вершинах
+inline uint64_t count(uint64_t n)
+{
+    return n > 0 ? triangle(n - 1) : 0;
+}
+
+// Номер пары (a, a + 1) -- начало строки a
+inline uint64_t rowStart(uint64_t n, uint64_t a)
+{
+    // a + (2n - a - 1) нечётно, поэтому ровно один из множителей чётный
+    uint64_t rest = 2 * n - a - 1;
+    return a % 2 == 0 ? a / 2 * rest : rest / 2 * a;
+}
+
+// Номер пары (a, b), a < b < n
+inline uint64_t encode(uint64_t n, uint64_t a, uint64_t b)
+{
+    return rowStart(n, a) + (b - a - 1);
+}
+
+/**
+ * Пара с номером index, вершины нумеруются с 0
+ *
+ * @details
+ *      Номер считается с конца: j = count(n) - 1 - index. Строки с конца содержат 1, 2, 3, ... пар,
+ *      поэтому строка с конца r -- наибольшее r с r (r + 1) / 2 <= j, то есть isqrt(2j) или на
+ *      единицу меньше. 2j < 2^64, пока n < 2^32.
+ *
+ * @param n количество вершин
+ * @param index номер пары, меньше count(n)
+ * @complexity O(1)
+ */
+template<class Index>
+BasicEdge<Index> decode(uint64_t n, uint64_t index)
+{
+    uint64_t j = count(n) - 1 - index;
+    uint64_t r = isqrt(2 * j);
+    if (triangle(r) > j)
+        --r;
+    return {static_cast<Index>(n - 2 - r), static_cast<Index>(n - 1 - (j - triangle(r)))};
+}
+
+/**
+ * Пары с номерами index[0..size) в out[0..size)
+ *
+ * @details
+ *      С AVX2 номера обрабатываются по четыре: корень берётся векторно в double, а его
+ *      ошибка (не больше единицы в каждую сторону) исправляется целочисленными сравнениями
+ *      r (r + 1) / 2 с j, как в скалярной версии. Строка r не больше n, поэтому r (r + 1)
+ *      считается умножением 32 x 32 -> 64 бита. Хвост -- по одному.
+ *
+ * @complexity O(size)
+ */
+template<class Index>
+void decode(uint64_t n, const uint64_t* index, std::size_t size, BasicEdge<Index>* out)
+{
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i last = _mm256_set1_epi64x(static_cast<int64_t>(count(n) - 1));
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i rowBase = _mm256_set1_epi64x(static_cast<int64_t>(n - 2));
+    const __m256i colBase = _mm256_set1_epi64x(static_cast<int64_t>(n - 1));
+    // uint64 -> double: старшая и младшая половины через мантиссы 2^84 и 2^52
+    const __m256d high = _mm256_set1_pd(19342813113834066795298816.);        // 2^84
+    const __m256d highLow = _mm256_set1_pd(19342813118337666422669312.);     // 2^84 + 2^52
+    const __m256d low = _mm256_set1_pd(4503599627370496.);                   // 2^52
+    auto triangles = [one](__m256i r)
+    {
+        return _mm256_srli_epi64(_mm256_mul_epu32(r, _mm256_add_epi64(r, one)), 1);
+    };
+    for (; i + 4 <= size; i += 4)
+    {
+        __m256i j = _mm256_sub_epi64(last, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index + i)));
+        __m256i twoJ = _mm256_add_epi64(j, j);
+        __m256i hi = _mm256_or_si256(_mm256_srli_epi64(twoJ, 32), _mm256_castpd_si256(high));
+        __m256i lo = _mm256_blend_epi32(twoJ, _mm256_castpd_si256(low), 0xAA);
+        __m256d value = _mm256_add_pd(_mm256_sub_pd(_mm256_castsi256_pd(hi), highLow), _mm256_castsi256_pd(lo));
+        __m256d root = _mm256_add_pd(_mm256_floor_pd(_mm256_sqrt_pd(value)), low);
+        __m256i r = _mm256_sub_epi64(_mm256_castpd_si256(root), _mm256_castpd_si256(low));
+
+        // r -- не больше чем на два выше и на один ниже нужной строки
+        r = _mm256_add_epi64(r, _mm256_cmpgt_epi64(triangles(r), j));
+        r = _mm256_add_epi64(r, _mm256_cmpgt_epi64(triangles(r), j));
+        __m256i below = _mm256_cmpgt_epi64(triangles(_mm256_add_epi64(r, one)), j);
+        r = _mm256_add_epi64(r, _mm256_andnot_si256(below, one));
+
+        alignas(32) uint64_t first[4];
+        alignas(32) uint64_t second[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(first), _mm256_sub_epi64(rowBase, r));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(second),
+                           _mm256_sub_epi64(colBase, _mm256_sub_epi64(j, triangles(r))));
+        for (int k = 0; k < 4; ++k)
+            out[i + k] = {static_cast<Index>(first[k]), static_cast<Index>(second[k])};
+    }
+#endif
+    for (; i < size; ++i)
+        out[i] = decode<Index>(n, index[i]);
+}
+
+} // namespace pair_index
+
+#endif // PAIR_INDEX_H
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <math.h>
 #include "common.h"
+#include "pair_index.h"
 
 /**
  * Служебные функции, необходимые для работы алгоритмов
@@ -69,15 +70,6 @@ void write_vector_to_file(const std::vector<int> &vec, const std::string &filena
     outFile.close();
 }
 
-// Вычисление квадратного корня с точностью до одного одного знака после запятой
-double sq(SizeType N)
-{
-    SizeType a = static_cast<SizeType>(std::sqrt(N)); // Целая часть корня
-    double remainder = N - a * a;                     // Остаток при возведении в квадрат
-    return a + (remainder) / (2 * a);                 // Формула для первой десятичной цифры
-}
-
-
 /**
  * @brief Вычисляет индекс пары (a, b) в прямом порядке
  * 
@@ -85,27 +77,24 @@ double sq(SizeType N)
  *      (a, b) = (a, a + 1 + index - (a-1)*(2n-a)/2)
  * 
  *      where 0 <= index < (n*(n-1))/2
- *      and a is the largest integer such that a*(2n-a)/2 <= index
+ *      and a is the largest integer such that (a-1)*(2n-a)/2 <= index
+ *
+ *      Обёртка над pair_index::decode: точный целочисленный корень, все вычисления в uint64_t,
+ *      поэтому номера пар не обрезаются и при n > 65535.
  * 
  * @param[in] index индекс пары в прямом порядке
  * @param[in] n количество вершин
- * @return пара (a, b)
+ * @return пара (a, b), вершины нумеруются с 1
  * @throw std::runtime_error при ошибке out of range
  */
-EdgeType pair_from_index(SizeType index, SizeType n)
+template<class Index>
+BasicEdge<Index> pair_from_index(uint64_t index, Index n)
 {
-    // Решаем квадратное уравнение a^2 - a - 2 * index = 0
-    // Берем ближайшее целое слева
-    SizeType a = (2 * n + 1 - sq((2 * n + 1) * (2 * n + 1) - 4 * (2 * index + 2 * n))) / 2;
-
-    // Вычисляем оставшийся индекс
-    SizeType b = index + a + 1 - (a - 1) * (2 * n - a) / 2;
-    if (a >= b || a < 0 || b < 0)
-    {
-        //std::cout << a << " " << b << std::endl;
+    if (n < 2 || index >= pair_index::count(n))
         throw std::runtime_error("validation error");
-    }
-    return {a, b};
+
+    BasicEdge<Index> pair = pair_index::decode<Index>(n, index);
+    return {static_cast<Index>(pair.first + 1), static_cast<Index>(pair.second + 1)};
 }
 
 
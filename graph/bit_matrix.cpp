@@ -0,0 +1,85 @@
+#include "bit_matrix.h"
+
+#include <algorithm>
+#include <new>
+
+namespace
+{
+
+// Слов в строке матрицы на n вершин: n бит, округлённые до целой строки кэша
+std::size_t wordsPerRow(uint64_t n, std::size_t wordsPerLine)
+{
+    return (n + 64 * wordsPerLine - 1) / (64 * wordsPerLine) * wordsPerLine;
+}
+
+} // namespace
+
+template<class Index>
+void BasicBitMatrixGraph<Index>::reset(Index n, bool full)
+{
+    m_size = n;
+    m_rowWords = wordsPerRow(n, kWordsPerLine);
+    std::size_t words = m_rowWords * n;
+    if (words > m_capacity)
+    {
+        m_bits.reset();
+        void* data = std::aligned_alloc(kAlign, words * sizeof(uint64_t));
+        if (data == nullptr)
+            throw std::bad_alloc();
+        m_bits.reset(static_cast<uint64_t*>(data));
+        m_capacity = words;
+    }
+    std::fill(m_bits.get(), m_bits.get() + words, full ? ~uint64_t(0) : 0);
+    if (!full)
+        return;
+
+    // Полный граф: убираем петли и биты за пределами n
+    const std::size_t usedWords = (n + 63) / 64;
+    const uint64_t lastMask = n % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (n % 64)) - 1;
+    for (Index v = 0; v < n; ++v)
+    {
+        uint64_t* bits = m_bits.get() + static_cast<std::size_t>(v) * m_rowWords;
+        bits[usedWords - 1] &= lastMask;
+        std::fill(bits + usedWords, bits + m_rowWords, 0);
+        bits[v / 64] &= ~(uint64_t(1) << (v % 64));
+    }
+}
+
+template<class Index>
+std::size_t BasicBitMatrixGraph<Index>::rowWords() const
+{
+    return m_rowWords;
+}
+
+template<class Index>
+Index BasicBitMatrixGraph<Index>::size() const
+{
+    return m_size;
+}
+
+template<class Index>
+std::size_t BasicBitMatrixGraph<Index>::edgesCount() const
+{
+    return bit_kernels::popcount(m_bits.get(), m_rowWords * m_size) / 2;
+}
+
+template<class Index>
+Index BasicBitMatrixGraph<Index>::degree(Index v) const
+{
+    return static_cast<Index>(bit_kernels::popcount(row(v), m_rowWords));
+}
+
+template<class Index>
+std::size_t BasicBitMatrixGraph<Index>::memoryUsage() const
+{
+    return m_capacity * sizeof(uint64_t);
+}
+
+template<class Index>
+uint64_t BasicBitMatrixGraph<Index>::matrixBytes(uint64_t n)
+{
+    return n * wordsPerRow(n, kWordsPerLine) * sizeof(uint64_t);
+}
+
+template class BasicBitMatrixGraph<SizeType>;
+template class BasicBitMatrixGraph<WideSizeType>;
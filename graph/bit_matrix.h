@@ -0,0 +1,161 @@
+#pragma once
+#ifndef BIT_MATRIX_H
+#define BIT_MATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "common/common.h"
+
+// Операции над битовыми строками (векторные при сборке с AVX2)
+namespace bit_kernels
+{
+
+/**
+ * Вызывает visit(w, bits) для каждого слова w, в котором row[w] & ~mask[w] не ноль
+ *
+ * @details
+ *      С AVX2 строка проверяется блоками по 4 слова: блок без новых битов пропускается одной
+ *      инструкцией vptest. Так просмотр строки, в которой почти все соседи уже посещены, стоит
+ *      words / 4 сравнений. row выровнена на 64 байта (строка BasicBitMatrixGraph).
+ */
+template<class Visit>
+inline void scanAndNot(const uint64_t* row, const uint64_t* mask, std::size_t words, Visit&& visit)
+{
+    std::size_t w = 0;
+#if defined(__AVX2__)
+    for (; w + 4 <= words; w += 4)
+    {
+        __m256i r = _mm256_load_si256(reinterpret_cast<const __m256i*>(row + w));
+        __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + w));
+        if (_mm256_testc_si256(m, r)) //< все биты строки уже есть в маске
+            continue;
+        for (std::size_t i = w; i < w + 4; ++i)
+            if (uint64_t bits = row[i] & ~mask[i])
+                visit(i, bits);
+    }
+#endif
+    for (; w < words; ++w)
+        if (uint64_t bits = row[w] & ~mask[w])
+            visit(w, bits);
+}
+
+// Число единичных битов в words словах
+inline uint64_t popcount(const uint64_t* data, std::size_t words)
+{
+    // четыре независимых суммы, чтобы popcnt соседних слов выполнялись параллельно
+    uint64_t sum[4] = {0, 0, 0, 0};
+    std::size_t w = 0;
+    for (; w + 4 <= words; w += 4)
+        for (int i = 0; i < 4; ++i)
+            sum[i] += __builtin_popcountll(data[w + i]);
+    for (; w < words; ++w)
+        sum[0] += __builtin_popcountll(data[w]);
+    return sum[0] + sum[1] + sum[2] + sum[3];
+}
+
+} // namespace bit_kernels
+
+/**
+ * Граф в виде битовой матрицы смежности n x n.
+ *
+ * @details
+ *      Строка v -- битовое множество соседей v; строки хранятся целиком (матрица симметрична)
+ *      и выровнены на 64 байта, поэтому обход раскрывает вершину просмотром одной строки
+ *      за n / 64 слов, а соседи выдаются по возрастанию, как в CSR.
+ *
+ *      В отличие от CsrGraph, матрица всегда хранит сам граф, а не дополнение: для плотностей
+ *      около 0.5 n^2 / 8 байт меньше любого списка рёбер. Выбор представления -- matrixBytes.
+ *
+ * @tparam Index тип номера вершины
+ */
+template<class Index>
+class BasicBitMatrixGraph
+{
+public:
+    using IndexType = Index;
+
+    static constexpr std::size_t kAlign = 64;   // Выравнивание строк, байт
+    static constexpr std::size_t kWordsPerLine = kAlign / sizeof(uint64_t);
+
+    BasicBitMatrixGraph() = default;
+
+    /**
+     * Задаёт граф на n вершинах без рёбер (full == false) или полный граф (full == true)
+     *
+     * @details память перевыделяется, только если матрица растёт
+     * @throw std::bad_alloc если матрица не помещается в память
+     */
+    void reset(Index n, bool full);
+
+    void setEdge(Index a, Index b)
+    {
+        m_bits[a * m_rowWords + b / 64] |= uint64_t(1) << (b % 64);
+        m_bits[b * m_rowWords + a / 64] |= uint64_t(1) << (a % 64);
+    }
+
+    void clearEdge(Index a, Index b)
+    {
+        m_bits[a * m_rowWords + b / 64] &= ~(uint64_t(1) << (b % 64));
+        m_bits[b * m_rowWords + a / 64] &= ~(uint64_t(1) << (a % 64));
+    }
+
+    bool hasEdge(Index a, Index b) const
+    {
+        return (m_bits[a * m_rowWords + b / 64] >> (b % 64)) & 1;
+    }
+
+    // Строка соседей вершины v (rowWords() слов, биты за пределами n нулевые)
+    const uint64_t* row(Index v) const
+    {
+        return m_bits.get() + static_cast<std::size_t>(v) * m_rowWords;
+    }
+
+    // Число 64-битных слов в строке (кратно kWordsPerLine)
+    std::size_t rowWords() const;
+
+    // Вызывает visit(u) для каждого соседа v по возрастанию
+    template<class Visit>
+    void forEachNeighbor(Index v, Visit&& visit) const
+    {
+        const uint64_t* bits = row(v);
+        for (std::size_t w = 0; w < m_rowWords; ++w)
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1)
+                visit(static_cast<Index>(w * 64 + __builtin_ctzll(word)));
+    }
+
+    // Количество вершин
+    Index size() const;
+
+    // Количество неориентированных рёбер (подсчёт битов всей матрицы)
+    std::size_t edgesCount() const;
+
+    Index degree(Index v) const;
+
+    // Объём памяти (в байтах), занимаемый матрицей
+    std::size_t memoryUsage() const;
+
+    // Размер матрицы для графа на n вершинах, байт
+    static uint64_t matrixBytes(uint64_t n);
+
+private:
+    struct FreeDeleter
+    {
+        void operator()(uint64_t* data) const { std::free(data); }
+    };
+
+    std::unique_ptr<uint64_t[], FreeDeleter> m_bits;   // Строки подряд, по m_rowWords слов
+    std::size_t m_capacity = 0;                        // Выделено слов
+    std::size_t m_rowWords = 0;
+    Index m_size = 0;
+};
+
+using BitMatrixGraph = BasicBitMatrixGraph<SizeType>;
+
+#endif // BIT_MATRIX_H
@@ -0,0 +1,249 @@
+#include "csr.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+template<class Index>
+BasicCsrGraph<Index>::BasicCsrGraph(const List<Edge>& edges, Index n)
+{
+    assign(edges, n);
+}
+
+template<class Index>
+BasicCsrGraph<Index>::BasicCsrGraph(const BasicCsrGraph& other)
+    : m_offsets(other.m_offsets), m_neighbors(other.m_neighbors)
+{
+    bindLike(other);
+}
+
+template<class Index>
+BasicCsrGraph<Index>::BasicCsrGraph(BasicCsrGraph&& other) noexcept
+    : m_offsets(std::move(other.m_offsets)), m_neighbors(std::move(other.m_neighbors)),
+      m_scratch(std::move(other.m_scratch)), m_cursor(std::move(other.m_cursor)),
+      m_readCursor(std::move(other.m_readCursor))
+{
+    bindLike(other);
+    other.clear();
+}
+
+template<class Index>
+BasicCsrGraph<Index>& BasicCsrGraph<Index>::operator=(const BasicCsrGraph& other)
+{
+    if (this != &other)
+    {
+        m_offsets = other.m_offsets;
+        m_neighbors = other.m_neighbors;
+        bindLike(other);
+    }
+    return *this;
+}
+
+template<class Index>
+BasicCsrGraph<Index>& BasicCsrGraph<Index>::operator=(BasicCsrGraph&& other) noexcept
+{
+    if (this != &other)
+    {
+        m_offsets = std::move(other.m_offsets);
+        m_neighbors = std::move(other.m_neighbors);
+        m_scratch = std::move(other.m_scratch);
+        m_cursor = std::move(other.m_cursor);
+        m_readCursor = std::move(other.m_readCursor);
+        bindLike(other);
+        other.clear();
+    }
+    return *this;
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::bindLike(const BasicCsrGraph& other)
+{
+    // внешняя смежность общая, собственная -- уже скопирована или перемещена в this
+    if (other.m_attached)
+        attach(other.m_offsetData, other.m_neighborData, other.m_size);
+    else
+        bindStorage();
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::assign(const List<Edge>& edges, Index n)
+{
+    // Считаем степени вершин, сдвинутые на одну позицию, и превращаем их в смещения
+    m_offsets.assign(static_cast<std::size_t>(n) + 1, 0);
+    for (const auto& edge : edges)
+    {
+        if (edge.first >= n || edge.second >= n)
+            throw std::out_of_range("edge references missing vertex");
+        ++m_offsets[edge.first + 1];
+        ++m_offsets[edge.second + 1];
+    }
+    for (Index v = 0; v < n; ++v)
+        m_offsets[v + 1] += m_offsets[v];
+
+    // Раскладываем соседей по вершинам в порядке следования рёбер
+    m_scratch.resize(m_offsets[n]);
+    m_cursor.assign(m_offsets.begin(), m_offsets.end() - 1);
+    for (const auto& edge : edges)
+        placeEdge(edge.first, edge.second);
+
+    sortAdjacency();
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::startBuild(const List<Index>& degrees)
+{
+    m_offsets.resize(degrees.size() + 1);
+    m_offsets[0] = 0;
+    for (std::size_t v = 0; v < degrees.size(); ++v)
+        m_offsets[v + 1] = m_offsets[v] + degrees[v];
+    m_scratch.resize(m_offsets.back());
+    m_cursor.assign(m_offsets.begin(), m_offsets.end() - 1);
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::finishBuild()
+{
+    sortAdjacency();
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::addEdges(const List<Edge>& edges)
+{
+    addEdges([&edges](auto&& visit)
+    {
+        for (const auto& edge : edges)
+            visit(edge.first, edge.second);
+    });
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::spreadAdjacency(std::size_t added)
+{
+    detach();
+    // Раздвигаем списки от конца к началу: старые соседи вершины переезжают в хвост её нового
+    // диапазона, начало диапазона остаётся под новые рёбра
+    const Index n = size();
+    m_readCursor.resize(n);
+    OffsetType newEnd = m_neighbors.size() + 2 * added;
+    m_neighbors.resize(newEnd);
+    for (Index v = n; v-- > 0;)
+    {
+        OffsetType oldBegin = m_offsets[v];
+        OffsetType oldEnd = m_offsets[v + 1];
+        OffsetType newBegin = newEnd - (oldEnd - oldBegin) - m_cursor[v];
+        std::move_backward(m_neighbors.begin() + oldBegin, m_neighbors.begin() + oldEnd, m_neighbors.begin() + newEnd);
+        m_offsets[v + 1] = newEnd;
+        m_readCursor[v] = newEnd - (oldEnd - oldBegin);
+        m_cursor[v] = newBegin;
+        newEnd = newBegin;
+    }
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::sortAdjacency()
+{
+    // Граф неориентированный, поэтому, перебирая вершины v по возрастанию и дописывая v
+    // каждому её соседу, получаем отсортированные списки смежности
+    const Index n = static_cast<Index>(m_offsets.size() - 1);
+    m_neighbors.resize(m_scratch.size());
+    m_cursor.assign(m_offsets.begin(), m_offsets.end() - 1);
+    for (Index v = 0; v < n; ++v)
+        for (OffsetType i = m_offsets[v]; i < m_offsets[v + 1]; ++i)
+            m_neighbors[m_cursor[m_scratch[i]]++] = v;
+    bindStorage();
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::bindStorage()
+{
+    m_offsetData = m_offsets.data();
+    m_neighborData = m_neighbors.data();
+    m_size = m_offsets.empty() ? 0 : static_cast<Index>(m_offsets.size() - 1);
+    m_attached = false;
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::attach(const OffsetType* offsets, const Index* neighbors, Index n)
+{
+    m_offsetData = offsets;
+    m_neighborData = neighbors;
+    m_size = n;
+    m_attached = true;
+}
+
+template<class Index>
+bool BasicCsrGraph<Index>::isAttached() const
+{
+    return m_attached;
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::detach()
+{
+    if (!m_attached)
+        return;
+    m_offsets.assign(m_offsetData, m_offsetData + m_size + 1);
+    m_neighbors.assign(m_neighborData, m_neighborData + m_offsets.back());
+    bindStorage();
+}
+
+template<class Index>
+void BasicCsrGraph<Index>::clear()
+{
+    m_offsets.clear();
+    m_neighbors.clear();
+    bindStorage();
+}
+
+template<class Index>
+Index BasicCsrGraph<Index>::size() const
+{
+    return m_size;
+}
+
+template<class Index>
+std::size_t BasicCsrGraph<Index>::edgesCount() const
+{
+    return m_size == 0 ? 0 : m_offsetData[m_size] / 2;
+}
+
+template<class Index>
+Index BasicCsrGraph<Index>::degree(Index v) const
+{
+    return static_cast<Index>(m_offsetData[v + 1] - m_offsetData[v]);
+}
+
+template<class Index>
+typename BasicCsrGraph<Index>::Neighbors BasicCsrGraph<Index>::neighbors(Index v) const
+{
+    return {m_neighborData + m_offsetData[v], m_neighborData + m_offsetData[v + 1]};
+}
+
+template<class Index>
+bool BasicCsrGraph<Index>::hasEdge(Index a, Index b) const
+{
+    auto range = neighbors(a);
+    return std::binary_search(range.begin(), range.end(), b);
+}
+
+template<class Index>
+const OffsetType* BasicCsrGraph<Index>::offsetData() const
+{
+    return m_offsetData;
+}
+
+template<class Index>
+const Index* BasicCsrGraph<Index>::neighborData() const
+{
+    return m_neighborData;
+}
+
+template<class Index>
+std::size_t BasicCsrGraph<Index>::memoryUsage() const
+{
+    return m_offsets.capacity() * sizeof(OffsetType) + m_neighbors.capacity() * sizeof(Index)
+         + m_scratch.capacity() * sizeof(Index) + m_cursor.capacity() * sizeof(OffsetType);
+}
+
+template class BasicCsrGraph<SizeType>;
+template class BasicCsrGraph<WideSizeType>;
@@ -0,0 +1,256 @@
+#pragma once
+#ifndef CSR_H
+#define CSR_H
+
+#include <cstddef>
+#include <stdexcept>
+
+#include "common/common.h"
+
+/**
+ * Граф в формате CSR (compressed sparse row).
+ *
+ * @details
+ *      Списки смежности всех вершин лежат подряд в одном массиве m_neighbors,
+ *      а m_offsets[v] .. m_offsets[v + 1] задаёт диапазон соседей вершины v.
+ *      Соседи каждой вершины отсортированы по возрастанию, поэтому проверка ребра
+ *      выполняется бинарным поиском, а обходы читают память последовательно.
+ *
+ *      Для графов с плотностью >= MIN_INVERSE_DENSITY в структуре, как и раньше,
+ *      хранятся удалённые рёбра (дополнение графа).
+ *
+ *      Граф может не владеть смежностью, а читать её из внешней памяти (attach), например
+ *      из отображённого в память снимка. Построение и достройка такого графа сначала копируют
+ *      смежность в собственные массивы.
+ *
+ * @tparam Index тип номера вершины (SizeType или WideSizeType, см. dispatchIndex)
+ */
+template<class Index>
+class BasicCsrGraph
+{
+public:
+    using IndexType = Index;
+    using Edge = BasicEdge<Index>;
+
+    // Диапазон соседей вершины (легковесная замена std::span)
+    struct Neighbors
+    {
+        const Index* first;
+        const Index* last;
+
+        const Index* begin() const { return first; }
+        const Index* end() const { return last; }
+        std::size_t size() const { return last - first; }
+    };
+
+    BasicCsrGraph() = default;
+
+    // Копия и перемещение перенаправляют чтение на массивы нового объекта (внешняя смежность общая)
+    BasicCsrGraph(const BasicCsrGraph& other);
+    BasicCsrGraph(BasicCsrGraph&& other) noexcept;
+    BasicCsrGraph& operator=(const BasicCsrGraph& other);
+    BasicCsrGraph& operator=(BasicCsrGraph&& other) noexcept;
+
+    /**
+     * Строит граф по списку рёбер
+     *
+     * @param edges список неориентированных рёбер без петель и повторов
+     * @param n количество вершин
+     * @throw std::out_of_range если ребро ссылается на несуществующую вершину
+     */
+    BasicCsrGraph(const List<Edge>& edges, Index n);
+
+    /**
+     * Перестраивает граф по списку рёбер, переиспользуя уже выделенную память
+     *
+     * @param edges список неориентированных рёбер без петель и повторов
+     * @param n количество вершин
+     * @throw std::out_of_range если ребро ссылается на несуществующую вершину
+     * @complexity O(n + m)
+     */
+    void assign(const List<Edge>& edges, Index n);
+
+    /**
+     * Перестраивает граф по потоку рёбер, выданных по возрастанию, без сортировки списков смежности
+     *
+     * @details
+     *      Ребро (a, v), a < v, идёт в потоке раньше всех рёбер (v, b), поэтому соседи каждой
+     *      вершины приходят по возрастанию и записываются сразу на свои места. Поток читается
+     *      дважды, как в addEdges: подсчёт степеней и раскладка.
+     *
+     * @param stream поток нормализованных (first < second) рёбер по возрастанию, без повторов
+     * @param n количество вершин
+     * @throw std::out_of_range если ребро ссылается на несуществующую вершину
+     * @complexity O(n + m)
+     */
+    template<class EdgeStream>
+    void assignSorted(const EdgeStream& stream, Index n)
+    {
+        m_offsets.assign(static_cast<std::size_t>(n) + 1, 0);
+        stream([&](Index a, Index b)
+        {
+            if (a >= n || b >= n)
+                throw std::out_of_range("edge references missing vertex");
+            ++m_offsets[a + 1];
+            ++m_offsets[b + 1];
+        });
+        for (Index v = 0; v < n; ++v)
+            m_offsets[v + 1] += m_offsets[v];
+
+        m_neighbors.resize(m_offsets[n]);
+        m_cursor.assign(m_offsets.begin(), m_offsets.end() - 1);
+        stream([this](Index a, Index b)
+        {
+            m_neighbors[m_cursor[a]++] = b;
+            m_neighbors[m_cursor[b]++] = a;
+        });
+        bindStorage();
+    }
+
+    /**
+     * Начинает построение графа с заранее известными степенями вершин.
+     * Дальше каждое ребро записывается вызовом placeEdge, а построение завершается finishBuild.
+     * Так генераторы (например, распаковка кода Прюфера) пишут рёбра сразу на их места в CSR
+     * без промежуточного списка рёбер.
+     *
+     * @param degrees степени вершин; их количество задаёт число вершин
+     */
+    void startBuild(const List<Index>& degrees);
+
+    // Записывает ребро (a, b) в списки смежности обеих вершин (после startBuild)
+    void placeEdge(Index a, Index b)
+    {
+        m_scratch[m_cursor[a]++] = b;
+        m_scratch[m_cursor[b]++] = a;
+    }
+
+    // Завершает построение: сортирует списки смежности за O(n + m)
+    void finishBuild();
+
+    /**
+     * Добавляет в граф новые рёбра на месте, без перестроения уже записанной смежности
+     *
+     * @details
+     *      Списки смежности раздвигаются проходом от последней вершины к первой (новые позиции
+     *      не меньше старых, поэтому непрочитанные данные не затираются), после чего новые рёбра
+     *      вливаются слиянием. Отсортированность списков сохраняется.
+     *
+     *      Рёбра читаются из потока stream дважды (подсчёт степеней и слияние), поэтому генератор
+     *      может выдавать их на лету, не складывая в список: stream(visit) вызывает visit(a, b)
+     *      для каждого ребра и при повторном вызове выдаёт ту же последовательность.
+     *
+     * @param stream поток нормализованных (first < second) рёбер по возрастанию,
+     *               которых ещё нет в графе
+     * @throw std::out_of_range если ребро ссылается на несуществующую вершину
+     * @complexity O(n + m)
+     */
+    template<class EdgeStream>
+    void addEdges(const EdgeStream& stream)
+    {
+        const Index n = size();
+        // сколько новых соседей получит каждая вершина
+        m_cursor.assign(n, 0);
+        std::size_t added = 0;
+        stream([&](Index a, Index b)
+        {
+            if (a >= n || b >= n)
+                throw std::out_of_range("edge references missing vertex");
+            ++m_cursor[a];
+            ++m_cursor[b];
+            ++added;
+        });
+        spreadAdjacency(added);
+
+        // Рёбра отсортированы, поэтому новые соседи каждой вершины приходят по возрастанию:
+        // сливаем их со старыми. Позиция записи никогда не обгоняет позицию чтения.
+        stream([this](Index a, Index b)
+        {
+            mergeNeighbor(a, b);
+            mergeNeighbor(b, a);
+        });
+        bindStorage();
+    }
+
+    // То же для готового отсортированного списка нормализованных рёбер
+    void addEdges(const List<Edge>& edges);
+
+    /**
+     * Делает граф представлением чужой смежности без копирования (только для чтения)
+     *
+     * @param offsets n + 1 смещений списков смежности
+     * @param neighbors отсортированные списки смежности всех вершин подряд
+     * @param n количество вершин
+     * @note память должна жить, пока граф к ней привязан (до следующего построения или clear)
+     */
+    void attach(const OffsetType* offsets, const Index* neighbors, Index n);
+
+    // Смежность читается из внешней памяти (см. attach)
+    bool isAttached() const;
+
+    // Удаляет все вершины и рёбра (выделенная память сохраняется)
+    void clear();
+
+    // Количество вершин
+    Index size() const;
+
+    // Количество неориентированных рёбер
+    std::size_t edgesCount() const;
+
+    Index degree(Index v) const;
+
+    // Отсортированный по возрастанию список соседей вершины v
+    Neighbors neighbors(Index v) const;
+
+    // Проверка наличия ребра за O(log deg)
+    bool hasEdge(Index a, Index b) const;
+
+    // Смещения списков смежности (size() + 1 элементов) и сами списки -- для записи снимков
+    const OffsetType* offsetData() const;
+    const Index* neighborData() const;
+
+    // Объём собственной памяти (в байтах), занимаемой смежностью
+    std::size_t memoryUsage() const;
+
+private:
+    // Упорядочивает соседей каждой вершины: неотсортированные списки из m_scratch
+    // "транспонируются" в m_neighbors за O(n + m) без сравнений
+    void sortAdjacency();
+
+    // Раздвигает списки смежности под added новых рёбер (степени прироста лежат в m_cursor)
+    void spreadAdjacency(std::size_t added);
+
+    // Направляет чтение графа на собственные массивы (после их изменения)
+    void bindStorage();
+
+    // Копирует внешнюю смежность в собственные массивы перед изменением графа
+    void detach();
+
+    // Читает ту же смежность, что и other, после копирования или перемещения его массивов
+    void bindLike(const BasicCsrGraph& other);
+
+    // Вливает нового соседа в список смежности вершины v (после spreadAdjacency)
+    void mergeNeighbor(Index v, Index neighbor)
+    {
+        OffsetType end = m_offsets[v + 1];
+        while (m_readCursor[v] < end && m_neighbors[m_readCursor[v]] < neighbor)
+            m_neighbors[m_cursor[v]++] = m_neighbors[m_readCursor[v]++];
+        m_neighbors[m_cursor[v]++] = neighbor;
+    }
+
+    List<OffsetType> m_offsets;   // Начало списка смежности каждой вершины (n + 1 элемент)
+    List<Index> m_neighbors;      // Списки смежности всех вершин подряд
+    List<Index> m_scratch;        // Буфер для сортировки списков смежности
+    List<OffsetType> m_cursor;    // Позиции записи при раскладке рёбер по вершинам
+    List<OffsetType> m_readCursor; // Позиции чтения старой смежности при слиянии (addEdges)
+
+    // Смежность, которую читают запросы: собственные массивы или внешняя память (attach)
+    const OffsetType* m_offsetData = nullptr;
+    const Index* m_neighborData = nullptr;
+    Index m_size = 0;
+    bool m_attached = false;
+};
+
+// Граф с компактными номерами вершин (до 65535 вершин)
+using CsrGraph = BasicCsrGraph<SizeType>;
+
+#endif // CSR_H
@@ -0,0 +1,98 @@
+#include "density_ladder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "graph/edge.h"
+#include "randomizer/sample.h"
+
+template<class Index>
+void BasicDensityLadder<Index>::start(const BasicCsrGraph<Index>& tree, const Randomizer& rand)
+{
+    getTreeEdges(tree, m_present);
+    m_removed.clear();
+    m_rand = rand;
+    m_density = 0;
+    m_size = tree.size();
+    m_inverse = false;
+}
+
+template<class Index>
+void BasicDensityLadder<Index>::next(double density)
+{
+    if (density < m_density)
+        throw std::invalid_argument("density ladder must not decrease");
+    m_density = density;
+    const uint64_t maxEdges = static_cast<uint64_t>(m_size) * (m_size - 1) / 2;
+
+    if (density < MIN_INVERSE_DENSITY)
+    {
+        uint64_t needMinEdges = std::round(maxEdges * density);
+        if (m_present.size() >= needMinEdges)
+            return;
+        // новые рёбра -- равномерная выборка из пар, которых ещё нет в графе
+        m_fresh.clear();
+        samplePairs(m_size, m_present, needMinEdges - m_present.size(), m_rand, [this](Index a, Index b)
+        {
+            m_fresh.push_back(Edge{a, b});
+        });
+        m_merged.resize(m_present.size() + m_fresh.size());
+        std::merge(m_present.begin(), m_present.end(), m_fresh.begin(), m_fresh.end(), m_merged.begin());
+        m_present.swap(m_merged);
+        return;
+    }
+
+    // при переходе через MIN_INVERSE_DENSITY пар вне графа может быть на округление меньше
+    uint64_t edgesToRemove = std::min<uint64_t>(std::round(maxEdges * (1 - density)), maxEdges - m_present.size());
+    if (!m_inverse)
+    {
+        // удаляются только пары, которых нет в графе меньших плотностей
+        m_inverse = true;
+        m_removed.clear();
+        samplePairs(m_size, m_present, edgesToRemove, m_rand, [this](Index a, Index b)
+        {
+            m_removed.push_back(Edge{a, b});
+        });
+        return;
+    }
+    if (m_removed.size() <= edgesToRemove)
+        return;
+    // остаётся равномерное подмножество удалённых рёбер; места выборки возрастают, так что сдвиг на месте
+    std::size_t kept = 0;
+    sampleSorted(m_removed.size(), edgesToRemove, m_rand, [&](uint64_t rank)
+    {
+        m_removed[kept++] = m_removed[rank];
+    });
+    m_removed.resize(kept);
+}
+
+template<class Index>
+void BasicDensityLadder<Index>::build(BasicCsrGraph<Index>& graph) const
+{
+    const List<Edge>& edges = m_inverse ? m_removed : m_present;
+    graph.assignSorted([&edges](auto&& visit)
+    {
+        for (const Edge& edge : edges)
+            visit(edge.first, edge.second);
+    }, m_size);
+}
+
+template<class Index>
+void BasicDensityLadder<Index>::build(BasicBitMatrixGraph<Index>& matrix) const
+{
+    matrix.reset(m_size, m_inverse);
+    if (m_inverse)
+    {
+        for (const Edge& edge : m_removed)
+            matrix.clearEdge(edge.first, edge.second);
+    }
+    else
+    {
+        for (const Edge& edge : m_present)
+            matrix.setEdge(edge.first, edge.second);
+    }
+}
+
+template class BasicDensityLadder<SizeType>;
+template class BasicDensityLadder<WideSizeType>;
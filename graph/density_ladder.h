@@ -0,0 +1,70 @@
+#pragma once
+#ifndef DENSITY_LADDER_H
+#define DENSITY_LADDER_H
+
+#include "common/common.h"
+#include "graph/bit_matrix.h"
+#include "graph/csr.h"
+#include "randomizer/rand.h"
+
+/**
+ * Лестница плотностей: графы одного остовного дерева для возрастающих плотностей,
+ * каждый из которых содержит предыдущий.
+ *
+ * @details
+ *      Это то же, что дать каждой паре вне дерева свой равномерный ключ и для плотности p
+ *      взять дерево и пары с ключом ниже порога p: граф следующей плотности получается из
+ *      предыдущего добавлением рёбер, а случайные числа у всех плотностей общие.
+ *
+ *      Для плотностей ниже MIN_INVERSE_DENSITY к набору добавленных рёбер дописывается
+ *      равномерная выборка из ещё свободных пар. На первой высокой плотности удалённые рёбра
+ *      выбираются среди пар, не вошедших в граф, а дальше из них оставляется равномерное
+ *      подмножество нужного размера. Поэтому граф каждой плотности распределён так же,
+ *      как граф, построенный setGraphDensity с нуля: дерево плюс равномерная выборка пар
+ *      нужного размера. Генерация серии стоит столько же, сколько генерация самого плотного
+ *      графа; перестраивается только представление графа (O(n + m) на плотность).
+ *
+ * @tparam Index тип номера вершины
+ */
+template<class Index>
+class BasicDensityLadder
+{
+public:
+    using Edge = BasicEdge<Index>;
+
+    /**
+     * Начинает серию графов
+     *
+     * @param tree остовное дерево
+     * @param rand генератор случайных чисел серии (копируется и дальше продвигается с каждой плотностью)
+     */
+    void start(const BasicCsrGraph<Index>& tree, const Randomizer& rand);
+
+    /**
+     * Переходит к графу плотности density
+     *
+     * @param density плотность; не меньше плотности предыдущего графа серии
+     * @throw std::invalid_argument если плотность меньше предыдущей
+     */
+    void next(double density);
+
+    // Записывает текущий граф в CSR (при плотности >= MIN_INVERSE_DENSITY -- его дополнение)
+    void build(BasicCsrGraph<Index>& graph) const;
+
+    // Записывает текущий граф в битовую матрицу
+    void build(BasicBitMatrixGraph<Index>& matrix) const;
+
+private:
+    List<Edge> m_present;   // Дерево и добавленные рёбра (отсортированы)
+    List<Edge> m_removed;   // Удалённые рёбра текущей высокой плотности (отсортированы)
+    List<Edge> m_fresh;     // Рёбра, добавленные на очередном шаге
+    List<Edge> m_merged;    // Буфер слияния
+    Randomizer m_rand{0};
+    double m_density = 0;   // Плотность текущего графа
+    Index m_size = 0;
+    bool m_inverse = false; // Текущий граф задан удалёнными рёбрами
+};
+
+using DensityLadder = BasicDensityLadder<SizeType>;
+
+#endif // DENSITY_LADDER_H
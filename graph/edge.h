@@ -5,104 +5,221 @@
 #include <iostream>
 #include <cmath>
 #include <chrono>
+#include <algorithm>
 
 #include "common/common.h"
-#include "graph/node.h"
+#include "common/pair_index.h"
+#include "graph/bit_matrix.h"
+#include "graph/csr.h"
 #include "randomizer/rand.h"
+#include "randomizer/sample.h"
 
-// Заполняем множество номеров ребер, которые уже присутствуют в дереве
-// Потом это может быть использовано для больших плотностей, чтобы не исключить нужное ребро
-Set<EdgeType> getTreeEdges(const List<Node>& tree)
+/**
+ * Рабочие списки построения одного графа
+ *
+ * @details
+ *      Между графами списки очищаются, но память не освобождают: ёмкость держится на уровне
+ *      самого большого из уже построенных графов, и следующие графы того же размера строятся
+ *      без обращений к системному распределителю.
+ */
+template<class Index>
+struct BasicBuildBuffers
 {
-    Set<EdgeType> edgesInds;
-    edgesInds.reserve(tree.size() - 1);
-    for (const auto& elem : tree) //< для каждой вершины
-        for (const auto& inc : elem.incident) //< идем по списку смежности
-            edgesInds.insert(EdgeType{elem.data, tree[inc].data}); //< и запоминаем номера ребер
-    return edgesInds;
-}
+    List<int> prufer;                   // Последовательность Прюфера
+    List<Index> degree;                 // Степени вершин дерева при распаковке
+    List<BasicEdge<Index>> treeEdges;   // Рёбра остовного дерева
+};
 
-// добавляем ребро из первой вершины во вторую и обратно
-void insertEdge(List<Node>& graph, SizeType firstInd, SizeType secondInd)
+// приводим ребро к виду (меньшая вершина, большая вершина)
+template<class Index>
+BasicEdge<Index> normalizeEdge(Index first, Index second)
 {
-    auto& first = graph[firstInd];
-    auto& second = graph[secondInd];
-    first.incident.insert(secondInd);
-    second.incident.insert(firstInd);
+    return first < second ? BasicEdge<Index>{first, second} : BasicEdge<Index>{second, first};
 }
 
-// исключаем уже существующие ребра и петли
-bool checkEdgeInsertable(const List<Node>& graph, SizeType first, SizeType second)
+// Рёбра дерева в нормализованном виде, отсортированные по возрастанию (списки смежности уже отсортированы)
+template<class Index>
+void getTreeEdges(const BasicCsrGraph<Index>& tree, List<BasicEdge<Index>>& edges)
 {
-    if (first == second)
-        return false;
-    const auto& firstIncident = graph.at(first).incident;
-    // if elem is absent, count == 0, so we can insert it and vice versa
-    return firstIncident.count(second) == 0;
+    edges.clear();
+    edges.reserve(tree.edgesCount());
+    for (Index v = 0; v < tree.size(); ++v)
+        for (Index inc : tree.neighbors(v))
+            if (v < inc)
+                edges.push_back(BasicEdge<Index>{v, inc});
 }
 
-// генерируем пары случайных чисел и переводим их в ребра 
-void addEdgesToTreeByOne(List<Node>& tree, unsigned int edgesToAdd)
+/**
+ * Выбирает count случайных рёбер среди всех пар вершин, кроме запрещённых, и выдаёт их по возрастанию
+ *
+ * @details
+ *      Индексы выбираются последовательной выборкой (sampleSorted) из пространства пар за вычетом
+ *      запрещённых рёбер. Выбранный номер переводится в пару одним проходом: номер сдвигается на
+ *      число уже пройденных запрещённых рёбер, а строка треугольника продвигается вперёд по мере
+ *      роста номеров. Ни пары-кандидаты, ни выбранные рёбра не хранятся.
+ *
+ *      Результат определяется состоянием rand: копия генератора повторяет ту же выборку,
+ *      так что поток рёбер можно пройти повторно.
+ *
+ * @param[in] n количество вершин
+ * @param[in] exclude отсортированный список нормализованных рёбер, которые выбирать нельзя
+ * @param[in] count сколько рёбер выбрать (не больше числа разрешённых пар)
+ * @param[in] rand генератор случайных чисел
+ * @param[in] visit вызывается для каждого ребра: visit(a, b), a < b
+ * @complexity O(n + count + exclude.size())
+ * @space O(1)
+ */
+template<class Index, class Visitor>
+void samplePairs(Index n, const List<BasicEdge<Index>>& exclude, uint64_t count, Randomizer& rand, Visitor&& visit)
 {
-    Randomizer rand;
-    while (edgesToAdd > 0)
+    const uint64_t pairs = pair_index::count(n);
+    auto excluded = exclude.begin();
+    uint64_t skipped = 0;       // Сколько запрещённых пар осталось позади
+    Index row = 0;              // Первая вершина текущей пары
+    uint64_t rowBegin = 0;      // Номер пары (row, row + 1)
+    uint64_t rowEnd = n - 1;    // Номер первой пары следующей строки
+    sampleSorted(pairs - exclude.size(), count, rand, [&](uint64_t rank)
     {
-        SizeType firstInd = rand.uRand(0, tree.size() - 1);
-        SizeType secondInd = rand.uRand(0, tree.size() - 1);
-
-        if (checkEdgeInsertable(tree, firstInd, secondInd)) // пропускаем петли и уже существующие ребра
+        uint64_t index = rank + skipped;
+        while (excluded != exclude.end() && pair_index::encode(n, excluded->first, excluded->second) <= index)
         {
-            insertEdge(tree, firstInd, secondInd);
-            if (--edgesToAdd == 0)
-                return;
+            ++excluded;
+            ++skipped;
+            ++index;
         }
-    }
+        while (index >= rowEnd)
+        {
+            ++row;
+            rowBegin = rowEnd;
+            rowEnd += n - 1 - row;
+        }
+        visit(row, static_cast<Index>(row + 1 + (index - rowBegin)));
+    });
 }
 
-void inverseGraph(List<Node>& tree, double density)
+// Сколько рёбер удалить из полного графа на n вершинах ради плотности density (>= MIN_INVERSE_DENSITY):
+// рёбра дерева не удаляются, поэтому не больше числа остальных пар
+inline uint64_t removedEdgesCount(uint64_t n, double density)
 {
-    auto edges = getTreeEdges(tree);
-    for (auto& elem : tree)
-        elem.incident.clear();
+    uint64_t maxEdges = pair_index::count(n);
+    uint64_t treeEdges = n > 0 ? n - 1 : 0;
+    return std::min<uint64_t>(std::round(maxEdges * (1 - density)), maxEdges - treeEdges);
+}
 
-    unsigned int maxEdges = tree.size() * (tree.size() - 1)/2;
-    unsigned int edgesToRemove = std::round(maxEdges * (1-density));
-    Randomizer rand;
-    while (edgesToRemove > 0)
+/**
+ * Строит граф высокой плотности в виде дополнения: в graph попадают удалённые рёбра
+ *
+ * @details
+ *      Удалённые рёбра -- последовательная выборка (samplePairs) из пространства номеров пар
+ *      за вычетом рёбер дерева, поэтому они выдаются по возрастанию без отбраковки повторов и
+ *      рёбер дерева. По возрастанию выданные рёбра дают каждой вершине соседей тоже по возрастанию,
+ *      и assignSorted пишет их сразу на места в списках смежности, без списка рёбер и сортировки.
+ *      Как и в setGraphDensity для низких плотностей, выборка проходится дважды с копией rand.
+ *
+ * @param[in, out] graph на входе остовное дерево, рёбра которого удалять нельзя; на выходе дополнение графа
+ * @param[in] density плотность графа
+ * @param[in] rand генератор случайных чисел
+ * @param buffers рабочие списки
+ * @complexity O(n + число удалённых рёбер)
+ */
+template<class Index>
+void inverseGraph(BasicCsrGraph<Index>& graph, double density, Randomizer& rand, BasicBuildBuffers<Index>& buffers)
+{
+    const Index n = graph.size();
+    getTreeEdges(graph, buffers.treeEdges);
+    const List<BasicEdge<Index>>& treeEdges = buffers.treeEdges;
+    const uint64_t toRemove = removedEdgesCount(n, density);
+    graph.assignSorted([&](auto&& visit)
     {
-        SizeType firstInd = rand.uRand(0, tree.size() - 1);
-        SizeType secondInd = rand.uRand(0, tree.size() - 1);
-        if (edges.count({firstInd, secondInd}) == 0) // удаляем ребра, которых изначально не было
-            if (checkEdgeInsertable(tree, firstInd, secondInd)) // пропускаем петли и уже удаленные ребра
-            {
-                insertEdge(tree, firstInd, secondInd);
-                if (--edgesToRemove == 0)
-                    return;
-            }
-    }
+        Randomizer replay = rand;
+        samplePairs(n, treeEdges, toRemove, replay, visit);
+    }, n);
 }
-void setGraphDensity(List<Node>& tree, double density)
+
+/**
+ * Достраивает остовное дерево до графа заданной плотности
+ *
+ * @param[in, out] graph на входе остовное дерево, на выходе итоговый граф
+ *                       (при density >= MIN_INVERSE_DENSITY -- его дополнение)
+ * @param[in] density плотность графа
+ * @param[in] rand генератор случайных чисел
+ * @param buffers рабочие списки
+ */
+template<class Index>
+void setGraphDensity(BasicCsrGraph<Index>& graph, double density, Randomizer& rand, BasicBuildBuffers<Index>& buffers)
 {
     if (density >= MIN_INVERSE_DENSITY)
     {
-        inverseGraph(tree, density);
+        inverseGraph(graph, density, rand, buffers);
         return;
     }
-    SizeType curEdges = tree.size() - 1;
-    unsigned int maxEdges = tree.size()*(tree.size() - 1)/2;
-    unsigned int needMinEdges = std::round(maxEdges * density);
+    const Index n = graph.size();
+    std::size_t curEdges = graph.edgesCount();
+    std::size_t maxEdges = static_cast<std::size_t>(n) * (n - 1) / 2;
+    std::size_t needMinEdges = std::round(maxEdges * density);
     if (curEdges >= needMinEdges)
         return;
-    unsigned int needEdges = needMinEdges - curEdges; // считаем, сколько ребер добавить
 
-    using Clock = std::chrono::steady_clock;
+    getTreeEdges(graph, buffers.treeEdges);
+    const List<BasicEdge<Index>>& treeEdges = buffers.treeEdges;
+    uint64_t toAdd = std::min<uint64_t>(needMinEdges - curEdges, maxEdges - treeEdges.size());
+    // Рёбра не складываются в список: addEdges проходит поток дважды, каждый раз с копией генератора
+    graph.addEdges([&](auto&& visit)
+    {
+        Randomizer replay = rand;
+        samplePairs(n, treeEdges, toAdd, replay, visit);
+    });
+}
+
+// То же с временными рабочими списками
+template<class Index>
+void setGraphDensity(BasicCsrGraph<Index>& graph, double density, Randomizer& rand)
+{
+    BasicBuildBuffers<Index> buffers;
+    setGraphDensity(graph, density, rand, buffers);
+}
+
+/**
+ * Строит граф заданной плотности в битовой матрице по остовному дереву
+ *
+ * @details
+ *      Рёбра выбираются теми же выборками, что и в setGraphDensity для CSR, поэтому при том же
+ *      состоянии rand получается тот же граф. Матрица хранит сам граф: при density >= MIN_INVERSE_DENSITY
+ *      она заполняется полным графом, из которого вычёркиваются удалённые рёбра.
+ *
+ * @param[out] matrix итоговый граф
+ * @param[in] tree остовное дерево, рёбра которого удалять нельзя
+ * @param[in] density плотность графа
+ * @param[in] rand генератор случайных чисел
+ * @param buffers рабочие списки
+ */
+template<class Index>
+void setGraphDensity(BasicBitMatrixGraph<Index>& matrix, const BasicCsrGraph<Index>& tree, double density,
+                     Randomizer& rand, BasicBuildBuffers<Index>& buffers)
+{
+    const Index n = tree.size();
+    getTreeEdges(tree, buffers.treeEdges);
+    const List<BasicEdge<Index>>& treeEdges = buffers.treeEdges;
+    std::size_t maxEdges = static_cast<std::size_t>(n) * (n - 1) / 2;
 
-    //std::cerr << "starting edges generating\n";
-    Clock::time_point begin = Clock::now();
-    addEdgesToTreeByOne(tree, needEdges);
-    Clock::time_point end = Clock::now();
-    //std::cerr << "Time difference = " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << "[mcs] = "
-    //          << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1'000'000.0 << " sec" << '\n';
+    if (density >= MIN_INVERSE_DENSITY)
+    {
+        matrix.reset(n, true);
+        Randomizer replay = rand;
+        samplePairs(n, treeEdges, removedEdgesCount(n, density), replay,
+                    [&matrix](Index a, Index b) { matrix.clearEdge(a, b); });
+        return;
+    }
+
+    matrix.reset(n, false);
+    for (const auto& edge : treeEdges)
+        matrix.setEdge(edge.first, edge.second);
+    std::size_t needMinEdges = std::round(maxEdges * density);
+    if (treeEdges.size() >= needMinEdges)
+        return;
+    uint64_t toAdd = std::min<uint64_t>(needMinEdges - treeEdges.size(), maxEdges - treeEdges.size());
+    Randomizer replay = rand; //< как в CSR-версии: сам rand не продвигается
+    samplePairs(n, treeEdges, toAdd, replay, [&matrix](Index a, Index b) { matrix.setEdge(a, b); });
 }
 
-#endif //EDGE_H
\ No newline at end of file
+#endif //EDGE_H
@@ -0,0 +1,235 @@
+#include "ms_bfs.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+template<class Index>
+BasicMultiSourceBfs<Index>::BasicMultiSourceBfs(const Graph* graph)
+    : m_pGraph(graph)
+{}
+
+template<class Index>
+void BasicMultiSourceBfs<Index>::setGraph(const Graph* graph)
+{
+    m_pGraph = graph;
+    m_pMatrix = nullptr;
+}
+
+template<class Index>
+void BasicMultiSourceBfs<Index>::setGraph(const Matrix* matrix)
+{
+    m_pGraph = nullptr;
+    m_pMatrix = matrix;
+}
+
+template<class Index>
+Index BasicMultiSourceBfs<Index>::graphSize() const
+{
+    return m_pMatrix != nullptr ? m_pMatrix->size() : m_pGraph->size();
+}
+
+template<class Index>
+template<class OnLevel>
+void BasicMultiSourceBfs<Index>::run(const Index* sources, int count, uint64_t active, bool inverse, OnLevel&& onLevel)
+{
+    const Index n = graphSize();
+    // assign не перевыделяет память, если размер графа не вырос
+    m_seen.assign(n, 0);
+    m_frontier.assign(n, 0);
+    m_next.resize(n);
+    m_active = active;
+    for (int lane = 0; lane < count; ++lane)
+    {
+        uint64_t bit = uint64_t(1) << lane;
+        m_seen[sources[lane]] |= bit;
+        m_frontier[sources[lane]] |= bit;
+        m_levelCount[lane] = 1;
+    }
+
+    for (Index level = 1; m_active != 0; ++level)
+    {
+        if (m_pMatrix != nullptr)
+            expandMatrix();
+        else if (inverse)
+            expandInv();
+        else
+            expand();
+
+        // Оставляем только первые посещения и считаем новые вершины каждого поиска
+        std::fill(m_levelCount, m_levelCount + kLanes, 0);
+        for (Index v = 0; v < n; ++v)
+        {
+            uint64_t bits = m_next[v] & ~m_seen[v];
+            m_next[v] = bits;
+            m_seen[v] |= bits;
+            for (; bits != 0; bits &= bits - 1)
+                ++m_levelCount[__builtin_ctzll(bits)];
+        }
+        if (!onLevel(level))
+            break;
+        m_frontier.swap(m_next);
+    }
+}
+
+template<class Index>
+void BasicMultiSourceBfs<Index>::expand()
+{
+    std::fill(m_next.begin(), m_next.end(), 0);
+    for (Index u = 0; u < m_pGraph->size(); ++u)
+    {
+        uint64_t lanes = m_frontier[u] & m_active;
+        if (lanes == 0)
+            continue;
+        for (Index v : m_pGraph->neighbors(u))
+            m_next[v] |= lanes;
+    }
+}
+
+template<class Index>
+void BasicMultiSourceBfs<Index>::expandMatrix()
+{
+    std::fill(m_next.begin(), m_next.end(), 0);
+    for (Index u = 0; u < m_pMatrix->size(); ++u)
+    {
+        uint64_t lanes = m_frontier[u] & m_active;
+        if (lanes != 0)
+            m_pMatrix->forEachNeighbor(u, [&](Index v) { m_next[v] |= lanes; });
+    }
+}
+
+template<class Index>
+void BasicMultiSourceBfs<Index>::expandInv()
+{
+    uint64_t nonEmpty = 0;
+    for (int lane = 0; lane < kLanes; ++lane)
+        if (m_levelCount[lane] > 0)
+            nonEmpty |= uint64_t(1) << lane;
+    nonEmpty &= m_active;
+
+    uint32_t hits[kLanes];
+    for (Index v = 0; v < m_pGraph->size(); ++v)
+    {
+        uint64_t candidates = nonEmpty & ~m_seen[v];
+        m_next[v] = 0;
+        if (candidates == 0)
+            continue;
+
+        // Фронт, который больше числа удалённых соседей v, наверняка содержит соседа v.
+        // Для остальных поисков считаем, сколько вершин фронта связано с v удалённым ребром.
+        const Index removed = m_pGraph->degree(v);
+        uint64_t reached = 0;
+        uint64_t small = 0;
+        for (uint64_t bits = candidates; bits != 0; bits &= bits - 1)
+        {
+            int lane = __builtin_ctzll(bits);
+            if (m_levelCount[lane] > removed)
+                reached |= uint64_t(1) << lane;
+            else
+            {
+                small |= uint64_t(1) << lane;
+                hits[lane] = 0;
+            }
+        }
+        if (small != 0)
+        {
+            for (Index u : m_pGraph->neighbors(v))
+                for (uint64_t bits = m_frontier[u] & small; bits != 0; bits &= bits - 1)
+                    ++hits[__builtin_ctzll(bits)];
+            for (uint64_t bits = small; bits != 0; bits &= bits - 1)
+            {
+                int lane = __builtin_ctzll(bits);
+                if (hits[lane] < m_levelCount[lane])
+                    reached |= uint64_t(1) << lane;
+            }
+        }
+        m_next[v] = reached;
+    }
+}
+
+template<class Index>
+void BasicMultiSourceBfs<Index>::search(const Index* from, const Index* to, int count, double density)
+{
+    if (count > kLanes)
+        throw std::invalid_argument("too many searches in one batch");
+
+    uint64_t active = 0;
+    for (int lane = 0; lane < count; ++lane)
+    {
+        m_dist[lane] = 0;
+        m_visited[lane] = 0; //< как и Traverser, при совпадении концов ничего не извлекается
+        m_closer[lane] = 1;  //< начальная вершина
+        if (from[lane] != to[lane])
+            active |= uint64_t(1) << lane;
+    }
+
+    run(from, count, active, density >= MIN_INVERSE_DENSITY, [&](Index level)
+    {
+        uint64_t progressed = 0;
+        for (uint64_t bits = m_active; bits != 0; bits &= bits - 1)
+        {
+            int lane = __builtin_ctzll(bits);
+            uint64_t bit = uint64_t(1) << lane;
+            if (m_next[to[lane]] & bit)
+            {
+                m_dist[lane] = level;
+                m_visited[lane] = static_cast<Index>(m_closer[lane] + 1);
+                m_active &= ~bit;
+            }
+            else if (m_levelCount[lane] > 0)
+            {
+                m_closer[lane] += m_levelCount[lane];
+                progressed |= bit;
+            }
+        }
+        if (m_active & ~progressed)
+            throw std::runtime_error("target vertex is unreachable");
+        return m_active != 0;
+    });
+}
+
+template<class Index>
+Index BasicMultiSourceBfs<Index>::getDistance(int lane) const
+{
+    return m_dist[lane];
+}
+
+template<class Index>
+Index BasicMultiSourceBfs<Index>::getVisited(int lane) const
+{
+    return m_visited[lane];
+}
+
+template<class Index>
+List<uint64_t> BasicMultiSourceBfs<Index>::distanceDistribution(double density)
+{
+    const Index n = graphSize();
+    List<uint64_t> distribution(1, 0);
+    Index sources[kLanes];
+    for (Index first = 0; first < n; first += std::min<Index>(kLanes, n - first))
+    {
+        int count = std::min<int>(kLanes, n - first);
+        for (int lane = 0; lane < count; ++lane)
+            sources[lane] = static_cast<Index>(first + lane);
+        uint64_t all = count == kLanes ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+
+        run(sources, count, all, density >= MIN_INVERSE_DENSITY, [&](Index level)
+        {
+            uint64_t found = 0;
+            for (int lane = 0; lane < count; ++lane)
+                found += m_levelCount[lane];
+            if (found == 0)
+                return false;
+            if (distribution.size() <= level)
+                distribution.resize(level + 1, 0);
+            distribution[level] += found;
+            return true;
+        });
+    }
+    // каждая пара посчитана из обоих концов
+    for (auto& pairs : distribution)
+        pairs /= 2;
+    return distribution;
+}
+
+template class BasicMultiSourceBfs<SizeType>;
+template class BasicMultiSourceBfs<WideSizeType>;
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef MS_BFS_H
+#define MS_BFS_H
+
+#include <cstdint>
+
+#include "common/common.h"
+#include "graph/bit_matrix.h"
+#include "graph/csr.h"
+
+/**
+ * Одновременный поиск в ширину из многих источников (MS-BFS).
+ *
+ * @details
+ *      До kLanes поисков идут вместе по уровням: каждой вершине соответствует 64-битное слово,
+ *      бит l которого означает, что вершина посещена (или лежит во фронте) поиском номер l.
+ *      Один проход по смежности продвигает сразу все поиски, поэтому пачка из 64 поисков
+ *      стоит примерно как один обычный поиск в ширину плюс O(n) операций над битами на вершину.
+ *
+ *      Поиск идёт по уровням, поэтому порядок вершин внутри уровня не определён. Вместо
+ *      числа извлечений из очереди для каждого поиска сообщается число вершин, которые
+ *      строго ближе цели, плюс сама цель -- столько вершин извлёк бы обычный поиск в ширину,
+ *      если бы цель стояла первой в своём уровне.
+ *
+ *      Для графов высокой плотности (хранится дополнение) вершина v достижима из фронта поиска l,
+ *      если число вершин фронта больше, чем число вершин фронта среди удалённых соседей v.
+ *      Граф в виде битовой матрицы хранит сам граф, и его уровень раскрывается по строкам матрицы.
+ *
+ * @tparam Index тип номера вершины
+ */
+template<class Index>
+class BasicMultiSourceBfs
+{
+public:
+    using Graph = BasicCsrGraph<Index>;
+    using Matrix = BasicBitMatrixGraph<Index>;
+
+    static constexpr int kLanes = 64; // Число поисков в одной пачке
+
+    // Рабочие массивы переживают смену графа и перевыделяются, только если граф вырос
+    explicit BasicMultiSourceBfs(const Graph* graph = nullptr);
+
+    // Переключает поиск на другой граф
+    void setGraph(const Graph* graph);
+    void setGraph(const Matrix* matrix);
+
+    /**
+     * Выполняет пачку поисков пути from[l] -> to[l]
+     *
+     * @param from начальные вершины
+     * @param to конечные вершины
+     * @param count число поисков (не больше kLanes)
+     * @param density плотность графа: в случае большой плотности будет выбран инвертированный обход
+     * @throw std::runtime_error если какая-то из целей недостижима
+     * @throw std::invalid_argument если count > kLanes
+     */
+    void search(const Index* from, const Index* to, int count, double density);
+
+    // Длина кратчайшего пути поиска lane
+    Index getDistance(int lane) const;
+
+    // Число вершин ближе цели плюс сама цель для поиска lane
+    Index getVisited(int lane) const;
+
+    /**
+     * Распределение расстояний между всеми парами вершин графа
+     *
+     * @details Источники обрабатываются пачками по kLanes, всего n / kLanes проходов по графу.
+     *
+     * @param density плотность графа
+     * @return элемент d -- число неупорядоченных пар вершин на расстоянии d (элемент 0 равен нулю);
+     *         недостижимые пары не учитываются
+     */
+    List<uint64_t> distanceDistribution(double density);
+
+private:
+    // Общий цикл по уровням для поисков из маски active; для каждого уровня вызывает onLevel(level),
+    // пока он возвращает true. Новые вершины уровня лежат в m_next (уже добавлены в m_seen),
+    // число новых вершин каждого поиска -- в m_levelCount
+    template<class OnLevel>
+    void run(const Index* sources, int count, uint64_t active, bool inverse, OnLevel&& onLevel);
+
+    // Один шаг по уровню: m_frontier -> m_next для поисков из m_active
+    void expand();
+    void expandInv();
+    void expandMatrix();
+
+    // Количество вершин графа в любом представлении
+    Index graphSize() const;
+
+    const Graph* m_pGraph;
+    const Matrix* m_pMatrix = nullptr;
+    List<uint64_t> m_seen;         // Поиски, посетившие вершину
+    List<uint64_t> m_frontier;     // Поиски, у которых вершина во фронте текущего уровня
+    List<uint64_t> m_next;         // Поиски, впервые дошедшие до вершины на новом уровне
+    uint64_t m_active = 0;         // Ещё не завершившиеся поиски
+    uint32_t m_levelCount[kLanes] = {};    // Число новых вершин каждого поиска на уровне (размер фронта)
+    uint32_t m_closer[kLanes] = {};        // Сколько вершин поиск прошёл до уровня цели
+    Index m_dist[kLanes] = {};
+    Index m_visited[kLanes] = {};
+};
+
+using MultiSourceBfs = BasicMultiSourceBfs<SizeType>;
+
+#endif // MS_BFS_H
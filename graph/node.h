@@ -6,16 +6,18 @@
 
 #include "common/common.h"
 
-// Структура узла графа
-struct Node
+// Структура узла графа (Index -- тип номера вершины)
+template<class Index>
+struct BasicNode
 {
 	// Конструктор принимает ID узла и список инцидентных узлов
-	Node(SizeType id, Set<SizeType> nodes) : data(id), incident(nodes)
+	BasicNode(Index id, Set<Index> nodes) : data(id), incident(nodes)
 		{ }
 
-    SizeType data;            // Значение узла
-	Set<SizeType> incident;   // Список соседних узлов (смежность)
+    Index data;            // Значение узла
+	Set<Index> incident;   // Список соседних узлов (смежность)
 };
 
+using Node = BasicNode<SizeType>;
 
 #endif // NODE_H
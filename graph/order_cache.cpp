@@ -0,0 +1,40 @@
+#include "order_cache.h"
+
+#include <algorithm>
+#include <queue>
+#include <stack>
+
+template<class Index>
+void BasicOrderCache<Index>::reserve(Index n)
+{
+    m_rank.resize(n);
+    m_depth.resize(n);
+    m_unreached = n;
+}
+
+template<class Index>
+template<class StorageType>
+void BasicOrderCache<Index>::build(BasicTraverser<Index>& traverser, Index from, double density)
+{
+    traverser.clear();
+    traverser.template traverseAll<StorageType>(from, density);
+    const List<Index>& order = traverser.getTraverseOrder();
+
+    std::fill(m_rank.begin(), m_rank.end(), m_unreached);
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        Index v = order[i];
+        m_rank[v] = static_cast<Index>(i);
+        // предок извлекается раньше вершины, поэтому его глубина уже известна
+        m_depth[v] = v == from ? 0 : m_depth[traverser.getPrev(v)] + 1;
+    }
+}
+
+template class BasicOrderCache<SizeType>;
+template class BasicOrderCache<WideSizeType>;
+template void BasicOrderCache<SizeType>::build<std::queue<SizeType>>(BasicTraverser<SizeType>&, SizeType, double);
+template void BasicOrderCache<SizeType>::build<std::stack<SizeType>>(BasicTraverser<SizeType>&, SizeType, double);
+template void BasicOrderCache<WideSizeType>::build<std::queue<WideSizeType>>(BasicTraverser<WideSizeType>&, WideSizeType,
+                                                                             double);
+template void BasicOrderCache<WideSizeType>::build<std::stack<WideSizeType>>(BasicTraverser<WideSizeType>&, WideSizeType,
+                                                                             double);
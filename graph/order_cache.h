@@ -0,0 +1,58 @@
+#pragma once
+#ifndef ORDER_CACHE_H
+#define ORDER_CACHE_H
+
+#include "common/common.h"
+#include "graph/traversal.h"
+
+/**
+ * Ответы на все поиски из одной начальной вершины по одному полному обходу.
+ *
+ * @details
+ *      При фиксированном порядке соседей обход from -> to извлекает вершины в том же порядке,
+ *      что и полный обход из from, и останавливается на to. Поэтому число посещённых вершин
+ *      поиска -- это место to в полном порядке обхода плюс один, а длина найденного пути --
+ *      глубина to в дереве полного обхода (для поиска в ширину -- расстояние).
+ *
+ *      build выполняет полный обход и запоминает место и глубину каждой вершины, после чего
+ *      любой поиск из той же вершины отвечается за O(1). Выгодно, когда из одной вершины
+ *      начинается несколько поисков: полный обход стоит не больше пары обходов с ранним выходом.
+ *
+ * @tparam Index тип номера вершины
+ */
+template<class Index>
+class BasicOrderCache
+{
+public:
+    // Готовит массивы под граф на n вершинах (память перевыделяется, только если граф вырос)
+    void reserve(Index n);
+
+    /**
+     * Полный обход из from и запоминание места и глубины каждой вершины
+     *
+     * @tparam StorageType тип стека или очереди: std::queue -- поиск в ширину, std::stack -- в глубину
+     * @param traverser обходчик графа (его рабочая память перезаписывается)
+     * @param from начальная вершина
+     * @param density плотность графа
+     */
+    template<class StorageType>
+    void build(BasicTraverser<Index>& traverser, Index from, double density);
+
+    // Достижима ли v из начальной вершины
+    bool reached(Index v) const { return m_rank[v] != m_unreached; }
+
+    // Число вершин, которые извлечёт обход из начальной вершины до v включительно (v достижима)
+    Index visited(Index v) const { return m_rank[v] + 1; }
+
+    // Длина пути до v по дереву обхода (v достижима)
+    Index distance(Index v) const { return m_depth[v]; }
+
+private:
+    List<Index> m_rank;    // Место вершины в порядке обхода (m_unreached -- не достигнута)
+    List<Index> m_depth;   // Глубина вершины в дереве обхода
+    Index m_unreached = 0; // Размер графа: места вершин меньше
+};
+
+using OrderCache = BasicOrderCache<SizeType>;
+
+#endif // ORDER_CACHE_H
@@ -0,0 +1,193 @@
+#include "snapshot.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace snapshot_format;
+
+namespace
+{
+
+// Заголовок снимка в том виде, в каком он лежит в файле
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t indexBytes;
+    uint64_t numVertices;
+    uint64_t neighborCount;
+    uint64_t seed;
+    double density;
+    uint32_t densityIndex;
+    uint32_t graphIndex;
+    uint32_t inverse;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(Header) == kHeaderSize, "snapshot header layout");
+
+// Списки соседей состоят из номеров вершин графа и строго возрастают (как в CSR)
+template<class Index>
+bool validNeighbors(const OffsetType* offsets, uint64_t numVertices)
+{
+    const Index* neighbors = reinterpret_cast<const Index*>(offsets + numVertices + 1);
+    for (uint64_t v = 0; v < numVertices; ++v)
+        for (OffsetType i = offsets[v]; i < offsets[v + 1]; ++i)
+            if (neighbors[i] >= numVertices || (i > offsets[v] && neighbors[i] <= neighbors[i - 1]))
+                return false;
+    return true;
+}
+
+} // namespace
+
+GraphSnapshot::GraphSnapshot(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Error opening file " + path);
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Error reading file " + path);
+    }
+    m_size = static_cast<std::size_t>(info.st_size);
+    if (m_size > 0)
+    {
+        // MAP_SHARED: страницы берутся прямо из страничного кэша и общие для всех процессов
+        void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Error mapping file " + path);
+        }
+        m_data = static_cast<const char*>(data);
+    }
+    ::close(fd); //< отображение остаётся действительным и после закрытия файла
+
+    try
+    {
+        parse(path);
+    }
+    catch (...)
+    {
+        unmap();
+        throw;
+    }
+}
+
+GraphSnapshot::~GraphSnapshot()
+{
+    unmap();
+}
+
+void GraphSnapshot::unmap()
+{
+    if (m_data != nullptr)
+        ::munmap(const_cast<char*>(m_data), m_size);
+    m_data = nullptr;
+}
+
+void GraphSnapshot::parse(const std::string& path)
+{
+    Header header;
+    if (m_size < kHeaderSize || std::memcmp(m_data, kMagic, sizeof(kMagic)) != 0)
+        throw std::runtime_error("Not a graph snapshot: " + path);
+    std::memcpy(&header, m_data, sizeof(header));
+    if (header.version != kVersion)
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(header.version) + ": " + path);
+    if (header.indexBytes != sizeof(SizeType) && header.indexBytes != sizeof(WideSizeType))
+        throw std::runtime_error("Bad vertex index width in snapshot " + path);
+    if (header.numVertices > std::numeric_limits<WideSizeType>::max())
+        throw std::runtime_error("Too many vertices in snapshot " + path);
+
+    // neighborCount ограничивается размером файла до умножения, чтобы произведение не переполнилось
+    const std::size_t offsetsBytes = (header.numVertices + 1) * sizeof(OffsetType);
+    if (header.neighborCount > (m_size - kHeaderSize) / header.indexBytes
+        || m_size != kHeaderSize + offsetsBytes + header.neighborCount * header.indexBytes)
+        throw std::runtime_error("Truncated graph snapshot: " + path);
+
+    // Смещения должны быть неубывающими и покрывать массив соседей: тогда обходы не выйдут за файл
+    const OffsetType* offsets = reinterpret_cast<const OffsetType*>(m_data + kHeaderSize);
+    if (offsets[0] != 0 || offsets[header.numVertices] != header.neighborCount)
+        throw std::runtime_error("Corrupted graph snapshot: " + path);
+    for (uint64_t v = 0; v < header.numVertices; ++v)
+        if (offsets[v] > offsets[v + 1])
+            throw std::runtime_error("Corrupted graph snapshot: " + path);
+    // Номер соседа вне графа вывел бы обход за пределы рабочей памяти
+    if (!(header.indexBytes == sizeof(SizeType) ? validNeighbors<SizeType>(offsets, header.numVertices)
+                                                : validNeighbors<WideSizeType>(offsets, header.numVertices)))
+        throw std::runtime_error("Corrupted graph snapshot: " + path);
+
+    m_info.numVertices = header.numVertices;
+    m_info.neighborCount = header.neighborCount;
+    m_info.indexBytes = header.indexBytes;
+    m_info.seed = header.seed;
+    m_info.density = header.density;
+    m_info.densityIndex = header.densityIndex;
+    m_info.graphIndex = header.graphIndex;
+    m_info.inverse = header.inverse != 0;
+}
+
+const SnapshotInfo& GraphSnapshot::info() const
+{
+    return m_info;
+}
+
+template<class Index>
+void GraphSnapshot::attach(BasicCsrGraph<Index>& graph) const
+{
+    if (m_info.indexBytes != sizeof(Index))
+        throw std::runtime_error("Snapshot vertex index width does not match the graph");
+    const OffsetType* offsets = reinterpret_cast<const OffsetType*>(m_data + kHeaderSize);
+    const Index* neighbors = reinterpret_cast<const Index*>(offsets + m_info.numVertices + 1);
+    graph.attach(offsets, neighbors, static_cast<Index>(m_info.numVertices));
+}
+
+template<class Index>
+void GraphSnapshot::write(const std::string& path, const BasicCsrGraph<Index>& graph, SnapshotInfo info)
+{
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.indexBytes = sizeof(Index);
+    header.numVertices = graph.size();
+    header.neighborCount = 2 * graph.edgesCount();
+    header.seed = info.seed;
+    header.density = info.density;
+    header.densityIndex = info.densityIndex;
+    header.graphIndex = info.graphIndex;
+    header.inverse = info.inverse ? 1 : 0;
+
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary);
+        if (!out)
+            throw std::runtime_error("Error opening file " + tmpPath);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(graph.offsetData()),
+                  (header.numVertices + 1) * sizeof(OffsetType));
+        out.write(reinterpret_cast<const char*>(graph.neighborData()), header.neighborCount * sizeof(Index));
+        if (!out)
+            throw std::runtime_error("Error writing file " + tmpPath);
+    }
+    std::filesystem::rename(tmpPath, path);
+}
+
+std::string GraphSnapshot::fileName(std::size_t densityIndex, int graphIndex)
+{
+    return "graph_" + std::to_string(densityIndex) + "_" + std::to_string(graphIndex) + ".csr";
+}
+
+template void GraphSnapshot::attach(BasicCsrGraph<SizeType>&) const;
+template void GraphSnapshot::attach(BasicCsrGraph<WideSizeType>&) const;
+template void GraphSnapshot::write(const std::string&, const BasicCsrGraph<SizeType>&, SnapshotInfo);
+template void GraphSnapshot::write(const std::string&, const BasicCsrGraph<WideSizeType>&, SnapshotInfo);
@@ -0,0 +1,108 @@
+#pragma once
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "common/common.h"
+#include "graph/csr.h"
+
+/**
+ * Формат снимка графа (двоичный файл с CSR одного графа).
+ *
+ * @details
+ *      Заголовок (64 байта):
+ *          char     magic[8]       "SIGCSR01"
+ *          uint32_t version        kVersion
+ *          uint32_t indexBytes     размер номера вершины: 2 (SizeType) или 4 (WideSizeType)
+ *          uint64_t numVertices
+ *          uint64_t neighborCount  длина массива соседей (удвоенное число хранимых рёбер)
+ *          uint64_t seed           главная затравка запуска, построившего граф
+ *          double   density        плотность графа
+ *          uint32_t densityIndex   координаты графа в сетке запуска
+ *          uint32_t graphIndex
+ *          uint32_t inverse        1, если хранится дополнение (density >= MIN_INVERSE_DENSITY)
+ *          uint32_t reserved       0
+ *      Дальше numVertices + 1 смещений uint64_t и neighborCount номеров вершин по indexBytes байт.
+ *
+ *      Массивы лежат по смещениям, кратным 8, поэтому отображённый в память файл читается
+ *      графом напрямую, без копирования. Числа записаны в порядке байтов машины.
+ */
+namespace snapshot_format
+{
+    constexpr char kMagic[8] = {'S', 'I', 'G', 'C', 'S', 'R', '0', '1'};
+    constexpr uint32_t kVersion = 1;
+    constexpr std::size_t kHeaderSize = 64;
+}
+
+// Параметры генерации графа, хранимые в снимке
+struct SnapshotInfo
+{
+    uint64_t numVertices = 0;
+    uint64_t neighborCount = 0;
+    uint32_t indexBytes = 0;
+    uint64_t seed = 0;
+    double density = 0;
+    uint32_t densityIndex = 0;
+    uint32_t graphIndex = 0;
+    bool inverse = false;
+};
+
+/**
+ * Снимок графа, отображённый в память только для чтения.
+ *
+ * @details
+ *      Страницы файла не копируются: граф, привязанный к снимку (attach), читает смежность
+ *      прямо из них, а система подгружает страницы по мере обхода. Отображение общее, поэтому
+ *      несколько процессов, читающих один каталог снимков, делят страничный кэш.
+ *      Снимок должен жить, пока к нему привязан граф.
+ */
+class GraphSnapshot
+{
+public:
+    /**
+     * @param path файл снимка
+     * @throw std::runtime_error если файл не открывается, повреждён или другой версии
+     */
+    explicit GraphSnapshot(const std::string& path);
+    ~GraphSnapshot();
+
+    GraphSnapshot(const GraphSnapshot&) = delete;
+    GraphSnapshot& operator=(const GraphSnapshot&) = delete;
+
+    const SnapshotInfo& info() const;
+
+    /**
+     * Привязывает граф к смежности снимка
+     *
+     * @throw std::runtime_error если номера вершин снимка другой ширины, чем Index
+     */
+    template<class Index>
+    void attach(BasicCsrGraph<Index>& graph) const;
+
+    /**
+     * Записывает граф в файл снимка (через временный файл, чтобы не оставить обрезанный)
+     *
+     * @param info параметры генерации; размеры и ширина номеров берутся из графа
+     * @throw std::runtime_error при ошибке записи
+     */
+    template<class Index>
+    static void write(const std::string& path, const BasicCsrGraph<Index>& graph, SnapshotInfo info);
+
+    // Имя файла снимка графа graphIndex плотности densityIndex внутри каталога снимков
+    static std::string fileName(std::size_t densityIndex, int graphIndex);
+
+private:
+    // Проверяет заголовок и размеры массивов
+    void parse(const std::string& path);
+
+    void unmap();
+
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    SnapshotInfo m_info;
+};
+
+#endif // SNAPSHOT_H
@@ -1,149 +1,837 @@
 #include "traversal.h"
+#include <algorithm>
 #include <stdexcept>
+#include <type_traits>
+
+namespace
+{
+
+/**
+ * Шаги поиска по уровням (traverseLevels) для CSR, хранящего сам граф
+ *
+ * @details
+ *      expand(cur, push) передаёт в push непосещённых соседей cur по возрастанию и отмечает их.
+ *      parent(v, queue, begin, end) -- место ближайшего к началу соседа v в уровне queue[begin, end)
+ *      или end, если v с уровнем не связана. bottomUp(queue, begin, end, found) перебирает
+ *      непосещённые вершины по возрастанию и для каждой, связанной с уровнем, вызывает
+ *      found(v, parent(v)); посещёнными такие вершины отмечает markVisited после раскладки уровня.
+ */
+template<class Index>
+class CsrLevels
+{
+public:
+    CsrLevels(const BasicCsrGraph<Index>& graph, BasicTraversalWorkspace<Index>& work)
+        : m_graph(graph), m_work(work)
+    {}
+
+    void start(Index from) { m_work.markVisited(from); }
+
+    template<class Push>
+    void expand(Index cur, Push&& push)
+    {
+        for (Index elem : m_graph.neighbors(cur))
+            if (!m_work.isVisited(elem))
+            {
+                m_work.markVisited(elem);
+                push(elem);
+            }
+    }
+
+    // Соседи v не упорядочены по месту в очереди, поэтому просматриваются все: шаг стоит
+    // столько же, сколько рёбер у непосещённых вершин
+    std::size_t parent(Index v, const List<Index>&, std::size_t begin, std::size_t end) const
+    {
+        std::size_t best = end;
+        for (Index u : m_graph.neighbors(v))
+            if (m_work.isVisited(u) && m_work.position(u) >= begin && m_work.position(u) < best)
+                best = m_work.position(u);
+        return best;
+    }
+
+    template<class Found>
+    void bottomUp(const List<Index>& queue, std::size_t begin, std::size_t end, Found&& found)
+    {
+        const Index n = m_graph.size();
+        for (Index v = 0; v < n; ++v)
+            if (!m_work.isVisited(v))
+            {
+                std::size_t position = parent(v, queue, begin, end);
+                if (position != end)
+                    found(v, position);
+            }
+    }
+
+    void markVisited(Index v) { m_work.markVisited(v); }
+
+private:
+    const BasicCsrGraph<Index>& m_graph;
+    BasicTraversalWorkspace<Index>& m_work;
+};
+
+// Шаги поиска по уровням для CSR, хранящего дополнение графа (удалённые рёбра)
+template<class Index>
+class ComplementLevels
+{
+public:
+    ComplementLevels(const BasicCsrGraph<Index>& graph, BasicTraversalWorkspace<Index>& work)
+        : m_graph(graph), m_work(work), m_next(work.unvisitedNext()), m_listEnd(graph.size())
+    {}
+
+    // Непосещённые вершины -- односвязный список по возрастанию, как в traverseInv
+    void start(Index from)
+    {
+        Index last = m_listEnd;
+        for (Index i = 0; i < m_graph.size(); ++i)
+            if (i != from)
+            {
+                m_next[last] = i;
+                last = i;
+            }
+        m_next[last] = m_listEnd;
+    }
+
+    template<class Push>
+    void expand(Index cur, Push&& push)
+    {
+        m_work.nextMark();
+        for (Index elem : m_graph.neighbors(cur))
+            m_work.mark(elem);
+        Index prevInList = m_listEnd;
+        for (Index i = m_next[m_listEnd]; i != m_listEnd; i = m_next[i])
+        {
+            if (m_work.isMarked(i)) //< ребро удалено
+            {
+                prevInList = i;
+                continue;
+            }
+            m_next[prevInList] = m_next[i];
+            push(i);
+        }
+    }
+
+    // Уровень просматривается по порядку до первой вершины, не связанной с v удалённым ребром:
+    // шаг стоит O(1 + число удалённых рёбер) на непосещённую вершину
+    std::size_t parent(Index v, const List<Index>& queue, std::size_t begin, std::size_t end)
+    {
+        m_work.nextMark();
+        for (Index elem : m_graph.neighbors(v))
+            m_work.mark(elem);
+        std::size_t position = begin;
+        while (position < end && m_work.isMarked(queue[position]))
+            ++position;
+        return position;
+    }
+
+    template<class Found>
+    void bottomUp(const List<Index>& queue, std::size_t begin, std::size_t end, Found&& found)
+    {
+        Index prevInList = m_listEnd;
+        for (Index v = m_next[m_listEnd]; v != m_listEnd; v = m_next[v])
+        {
+            std::size_t position = parent(v, queue, begin, end);
+            if (position == end)
+            {
+                prevInList = v;
+                continue;
+            }
+            m_next[prevInList] = m_next[v]; //< вершина вычёркивается из списка сразу
+            found(v, position);
+        }
+    }
+
+    void markVisited(Index) {}
+
+private:
+    const BasicCsrGraph<Index>& m_graph;
+    BasicTraversalWorkspace<Index>& m_work;
+    List<Index>& m_next;
+    const Index m_listEnd;
+};
+
+// Шаги поиска по уровням для битовой матрицы
+template<class Index>
+class MatrixLevels
+{
+public:
+    MatrixLevels(const BasicBitMatrixGraph<Index>& matrix, BasicTraversalWorkspace<Index>& work)
+        : m_matrix(matrix), m_work(work), m_words(matrix.rowWords())
+    {
+        work.clearBits(m_words);
+        m_visited = work.visitBits(0);
+    }
+
+    void start(Index from) { markVisited(from); }
+
+    template<class Push>
+    void expand(Index cur, Push&& push)
+    {
+        bit_kernels::scanAndNot(m_matrix.row(cur), m_visited, m_words, [&](std::size_t w, uint64_t bits)
+        {
+            m_visited[w] |= bits;
+            for (; bits != 0; bits &= bits - 1)
+                push(static_cast<Index>(w * 64 + __builtin_ctzll(bits)));
+        });
+    }
+
+    // Проверка ребра -- один бит, поэтому уровень просматривается по порядку до первого соседа
+    std::size_t parent(Index v, const List<Index>& queue, std::size_t begin, std::size_t end) const
+    {
+        std::size_t position = begin;
+        while (position < end && !m_matrix.hasEdge(v, queue[position]))
+            ++position;
+        return position;
+    }
+
+    template<class Found>
+    void bottomUp(const List<Index>& queue, std::size_t begin, std::size_t end, Found&& found)
+    {
+        const Index n = m_matrix.size();
+        for (std::size_t w = 0; w * 64 < n; ++w)
+            for (uint64_t bits = ~m_visited[w]; bits != 0; bits &= bits - 1)
+            {
+                std::size_t v = w * 64 + __builtin_ctzll(bits);
+                if (v >= n)
+                    break;
+                std::size_t position = parent(static_cast<Index>(v), queue, begin, end);
+                if (position != end)
+                    found(static_cast<Index>(v), position);
+            }
+    }
+
+    void markVisited(Index v) { m_visited[v / 64] |= uint64_t(1) << (v % 64); }
+
+private:
+    const BasicBitMatrixGraph<Index>& m_matrix;
+    BasicTraversalWorkspace<Index>& m_work;
+    const std::size_t m_words;
+    uint64_t* m_visited;
+};
+
+} // namespace
+
+template<class Index>
+BasicTraverser<Index>::BasicTraverser(const Graph* graph)
+    : m_pGraph(graph), m_ownWork(std::make_unique<Workspace>())
+{
+    m_pWork = m_ownWork.get();
+    m_pWork->reserve(graph->size());
+}
+
+template<class Index>
+BasicTraverser<Index>::BasicTraverser(const Graph* graph, Workspace* workspace)
+    : m_pGraph(graph), m_pWork(workspace)
+{
+    m_pWork->reserve(graph->size());
+    m_pWork->reset();
+}
+
+template<class Index>
+BasicTraverser<Index>::BasicTraverser(const Matrix* matrix, Workspace* workspace)
+    : m_pMatrix(matrix), m_pWork(workspace)
+{
+    m_pWork->reserve(matrix->size());
+    m_pWork->reset();
+}
+
+template<class Index>
+Index BasicTraverser<Index>::graphSize() const
+{
+    return m_pMatrix != nullptr ? m_pMatrix->size() : m_pGraph->size();
+}
+
+template<class Index>
+bool BasicTraverser<Index>::frontierExhausted(Index to) const
+{
+    if (!m_pWork->frontierEmpty())
+        return false;
+    if (to == graphSize()) //< полный обход закончен
+        return true;
+    throw std::runtime_error("target vertex is unreachable");
+}
 
 // Шаблонный метод traverse
+template<class Index>
 template <class StorageType>
-void Traverser::traverse(SizeType from, SizeType to)
+void BasicTraverser<Index>::traverse(Index from, Index to)
 {
+    if (m_pMatrix != nullptr)
+        return traverseMatrix<StorageType>(from, to);
+    auto& work = *m_pWork;
+    auto& visitOrder = work.visitOrder();
+    m_from = from;
+    m_bidir = false;
     // СД для хранения порядка обхода
-    StorageType toVisit;
-    toVisit.push(from);
-    SizeType cur = from;
+    work.push(from);
+    work.markVisited(from);
+    Index cur = from;
     
     while (cur != to)
     {
+        if (frontierExhausted(to))
+            break;
         // У stack и queue разные методы, поэтому завернули в шаблон
-        cur = extractElem(toVisit);
-        // Запоминаем, что зашли в вершину, и помещаем ее в историю
-        m_visited.insert(cur);
-        m_visitOrder.push_back(cur);
-        const auto& curNode = m_pNodes->at(cur);
-        for (auto elem : curNode.incident)
-            if (!m_visited.count(elem)) //< все вершины, которые еще не посещали
+        cur = extractElem<StorageType>();
+        // Помещаем вершину в историю (посещённой она отмечена при добавлении в СД)
+        visitOrder.push_back(cur);
+        for (auto elem : m_pGraph->neighbors(cur))
+            if (!work.isVisited(elem)) //< все вершины, которые еще не посещали
             {
-                toVisit.push(elem); //< помещаем в СД обхода
-                m_visited.insert(elem); //< отмечаем, что посетили
-                m_prev[elem] = cur; //< и запоминаем, откуда в них пришли
+                work.push(elem); //< помещаем в СД обхода
+                work.markVisited(elem); //< отмечаем, что посетили
+                work.setPrev(elem, cur); //< и запоминаем, откуда в них пришли
             }
         
     }
 }
 
+template<class Index>
 template <class StorageType>
-void Traverser::traverseInv(SizeType from, SizeType to)
+void BasicTraverser<Index>::traverseInv(Index from, Index to)
 {
+    if (m_pMatrix != nullptr) //< матрица хранит сам граф, а не дополнение
+        return traverseMatrix<StorageType>(from, to);
+    auto& work = *m_pWork;
+    auto& visitOrder = work.visitOrder();
+    auto& unvisitedNext = work.unvisitedNext();
+    const Index n = m_pGraph->size();
+    const Index listEnd = n; //< номер фиктивной вершины: голова и конец списка
+    m_from = from;
+    m_bidir = false;
+
+    // Непосещённые вершины храним в односвязном списке по возрастанию номеров.
+    // Каждый шаг по списку либо посещает вершину (и вычёркивает её), либо натыкается
+    // на удалённое ребро, поэтому весь обход стоит O(n + число удалённых рёбер).
+    for (Index i = 0; i < n; ++i)
+        unvisitedNext[i] = i + 1;
+    unvisitedNext[listEnd] = from == 0 ? 1 : 0;
+    if (from > 0)
+        unvisitedNext[from - 1] = from + 1; //< стартовая вершина посещена сразу
+
     // СД для хранения порядка обхода
-    StorageType toVisit;
-    toVisit.push(from);
-    SizeType cur = from;
+    work.push(from);
+    Index cur = from;
 
     while (cur != to)
     {
+        if (frontierExhausted(to))
+            break;
         // У stack и queue разные методы, поэтому завернули в шаблон
-        cur = extractElem(toVisit);
-        // Запоминаем, что зашли в вершину, и помещаем ее в историю
-        m_visited.insert(cur);
-        m_visitOrder.push_back(cur);
-        const auto& curNode = m_pNodes->at(cur);
-        for (SizeType i = 0; i < m_pNodes->size(); ++i)
-        if (curNode.incident.count(i) == 0) //< если ребро не удалено
-            if (!m_visited.count(i)) //< все вершины, которые еще не посещали
+        cur = extractElem<StorageType>();
+        // Помещаем вершину в историю (из списка непосещённых она уже вычеркнута)
+        visitOrder.push_back(cur);
+
+        // помечаем концы удалённых рёбер: метка действительна только для текущей вершины
+        work.nextMark();
+        for (auto elem : m_pGraph->neighbors(cur))
+            work.mark(elem);
+
+        Index prevInList = listEnd;
+        for (Index i = unvisitedNext[listEnd]; i != listEnd; i = unvisitedNext[i])
+        {
+            if (work.isMarked(i)) //< ребро удалено, вершина остаётся в списке
             {
-                toVisit.push(i); //< помещаем в СД обхода
-                m_visited.insert(i); //< отмечаем, что посетили
-                m_prev[i] = cur; //< и запоминаем, откуда в них пришли
+                prevInList = i;
+                continue;
             }
-        
+            work.push(i); //< помещаем в СД обхода
+            unvisitedNext[prevInList] = unvisitedNext[i]; //< отмечаем, что посетили
+            work.setPrev(i, cur); //< и запоминаем, откуда в них пришли
+        }
+    }
+}
+
+template<class Index>
+template <class StorageType>
+void BasicTraverser<Index>::traverseMatrix(Index from, Index to)
+{
+    auto& work = *m_pWork;
+    auto& visitOrder = work.visitOrder();
+    const std::size_t words = m_pMatrix->rowWords();
+    m_from = from;
+    m_bidir = false;
+    work.clearBits(words);
+    uint64_t* visited = work.visitBits(0);
+
+    work.push(from);
+    visited[from / 64] |= uint64_t(1) << (from % 64);
+    Index cur = from;
+    while (cur != to)
+    {
+        if (frontierExhausted(to))
+            break;
+        cur = extractElem<StorageType>();
+        visitOrder.push_back(cur);
+        // новые соседи -- строка cur без посещённых; биты выдаются по возрастанию номеров
+        bit_kernels::scanAndNot(m_pMatrix->row(cur), visited, words, [&](std::size_t w, uint64_t bits)
+        {
+            visited[w] |= bits;
+            for (; bits != 0; bits &= bits - 1)
+            {
+                Index elem = static_cast<Index>(w * 64 + __builtin_ctzll(bits));
+                work.push(elem);
+                work.setPrev(elem, cur);
+            }
+        });
     }
 }
 
 // Шаблонный метод traverse
+template<class Index>
 template <class StorageType>
-void Traverser::traverse(SizeType from, SizeType to, double density)
+void BasicTraverser<Index>::traverse(Index from, Index to, double density)
 {
-    if (density >= MIN_INVERSE_DENSITY)
+    if (m_pMatrix != nullptr)
+        traverseMatrix<StorageType>(from, to);
+    else if (density >= MIN_INVERSE_DENSITY)
         traverseInv<StorageType>(from, to);
     else
         traverse<StorageType>(from, to);
 }
 
+template<class Index>
+template<class Levels>
+void BasicTraverser<Index>::traverseLevels(Index from, Index to, Levels& levels, const DirectionHeuristic& heuristic)
+{
+    auto& work = *m_pWork;
+    const std::size_t n = graphSize();
+    m_from = from;
+    m_bidir = false;
+    if (from == to) //< как и traverse, ничего не извлекаем
+        return;
+
+    // Уровни лежат в очереди подряд: [begin, end) -- текущий фронт
+    List<Index>& queue = work.sideFrontier(0);
+    levels.start(from);
+    queue.push_back(from);
+    work.setPosition(from, 0);
+    std::size_t begin = 0;
+    std::size_t end = 1;
+    std::size_t target = n; //< место цели в очереди
+    bool bottomUp = false;
+    while (target == n)
+    {
+        const std::size_t frontier = end - begin;
+        if (frontier == 0)
+            throw std::runtime_error("target vertex is unreachable");
+        const std::size_t unvisited = n - end;
+        if (!bottomUp && frontier * heuristic.alpha > unvisited)
+            bottomUp = true;
+        else if (bottomUp && frontier * heuristic.beta < n)
+            bottomUp = false;
+
+        if (!bottomUp)
+        {
+            // Сверху вниз: порядок очереди складывается сам; как только цель поставлена в очередь,
+            // её место известно
+            for (std::size_t i = begin; i < end && target == n; ++i)
+            {
+                Index cur = queue[i];
+                levels.expand(cur, [&](Index elem)
+                {
+                    work.setPrev(elem, cur);
+                    work.setPosition(elem, static_cast<Index>(queue.size()));
+                    if (elem == to)
+                        target = queue.size();
+                    queue.push_back(elem);
+                });
+            }
+        }
+        else
+        {
+            // Снизу вверх: новые вершины приходят по возрастанию номеров; устойчивая сортировка
+            // подсчётом по месту родителя даёт порядок, в котором их поставил бы шаг сверху вниз.
+            // Если цель связана с уровнем, шаг сверху вниз остановился бы на её родителе: вершины
+            // с родителями дальше по уровню в порядок обхода не попадут, и их можно не искать.
+            std::size_t last = levels.parent(to, queue, begin, end);
+            last = last == end ? end : last + 1;
+            List<Index>& found = work.foundVertices();
+            List<Index>& parents = work.foundParents();
+            List<Index>& counts = work.parentCounts();
+            found.clear();
+            parents.clear();
+            levels.bottomUp(queue, begin, last, [&](Index v, std::size_t position)
+            {
+                found.push_back(v);
+                parents.push_back(static_cast<Index>(position - begin));
+            });
+            counts.assign(frontier + 1, 0);
+            for (Index parent : parents)
+                ++counts[parent + 1];
+            for (std::size_t i = 1; i <= frontier; ++i)
+                counts[i] += counts[i - 1];
+            queue.resize(end + found.size());
+            for (std::size_t i = 0; i < found.size(); ++i)
+            {
+                std::size_t place = end + counts[parents[i]]++;
+                Index v = found[i];
+                queue[place] = v;
+                work.setPrev(v, queue[begin + parents[i]]);
+                work.setPosition(v, static_cast<Index>(place));
+                levels.markVisited(v);
+                if (v == to)
+                    target = place;
+            }
+        }
+        begin = end;
+        end = queue.size();
+    }
+    // извлечены все вершины до цели включительно
+    work.visitOrder().assign(queue.begin(), queue.begin() + target + 1);
+}
+
+template<class Index>
+void BasicTraverser<Index>::traverseHybrid(Index from, Index to, double density, const DirectionHeuristic& heuristic)
+{
+    if (m_pMatrix != nullptr)
+    {
+        MatrixLevels<Index> levels(*m_pMatrix, *m_pWork);
+        traverseLevels(from, to, levels, heuristic);
+    }
+    else if (density >= MIN_INVERSE_DENSITY)
+    {
+        ComplementLevels<Index> levels(*m_pGraph, *m_pWork);
+        traverseLevels(from, to, levels, heuristic);
+    }
+    else
+    {
+        CsrLevels<Index> levels(*m_pGraph, *m_pWork);
+        traverseLevels(from, to, levels, heuristic);
+    }
+}
+
+template<class Index>
+bool BasicTraverser<Index>::startBidir(Index from, Index to)
+{
+    m_from = from;
+    m_to = to;
+    m_bidir = true;
+    if (from != to)
+        return false;
+    m_pWork->visitOrder().push_back(from);
+    m_meetFrom = m_meetTo = from;
+    return true;
+}
+
+template<class Index>
+void BasicTraverser<Index>::setMeeting(uint8_t side, Index cur, Index elem)
+{
+    m_meetFrom = side == 0 ? cur : elem;
+    m_meetTo = side == 0 ? elem : cur;
+}
+
+template<class Index>
+void BasicTraverser<Index>::traverseBidir(Index from, Index to)
+{
+    if (m_pMatrix != nullptr)
+        return traverseBidirMatrix(from, to);
+    auto& work = *m_pWork;
+    auto& visitOrder = work.visitOrder();
+    if (startBidir(from, to))
+        return;
+
+    // Каждая сторона -- очередь в своём массиве; [head, конец) -- её текущий уровень
+    List<Index>* queue[2] = {&work.sideFrontier(0), &work.sideFrontier(1)};
+    std::size_t head[2] = {0, 0};
+    queue[0]->push_back(from);
+    queue[1]->push_back(to);
+    work.markVisited(from, 0);
+    work.markVisited(to, 1);
+
+    while (true)
+    {
+        std::size_t levelSize[2] = {queue[0]->size() - head[0], queue[1]->size() - head[1]};
+        if (levelSize[0] == 0 || levelSize[1] == 0)
+            throw std::runtime_error("target vertex is unreachable");
+        // раскрываем уровень меньшего фронта
+        uint8_t side = levelSize[0] <= levelSize[1] ? 0 : 1;
+        auto& front = *queue[side];
+        std::size_t levelEnd = front.size();
+        while (head[side] < levelEnd)
+        {
+            Index cur = front[head[side]++];
+            visitOrder.push_back(cur);
+            for (auto elem : m_pGraph->neighbors(cur))
+            {
+                if (!work.isVisited(elem))
+                {
+                    front.push_back(elem);
+                    work.markVisited(elem, side);
+                    work.setPrev(elem, cur);
+                }
+                else if (work.side(elem) != side) //< фронты встретились
+                {
+                    setMeeting(side, cur, elem);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+template<class Index>
+void BasicTraverser<Index>::traverseBidirInv(Index from, Index to)
+{
+    if (m_pMatrix != nullptr)
+        return traverseBidirMatrix(from, to);
+    auto& work = *m_pWork;
+    auto& visitOrder = work.visitOrder();
+    auto& unvisitedNext = work.unvisitedNext();
+    const Index n = m_pGraph->size();
+    const Index listEnd = n; //< номер фиктивной вершины: голова и конец списка
+    if (startBidir(from, to))
+        return;
+
+    // Общий для обеих сторон список непосещённых вершин (без from и to)
+    Index last = listEnd;
+    for (Index i = 0; i < n; ++i)
+        if (i != from && i != to)
+        {
+            unvisitedNext[last] = i;
+            last = i;
+        }
+    unvisitedNext[last] = listEnd;
+
+    List<Index>* queue[2] = {&work.sideFrontier(0), &work.sideFrontier(1)};
+    std::size_t head[2] = {0, 0};
+    queue[0]->push_back(from);
+    queue[1]->push_back(to);
+
+    while (true)
+    {
+        std::size_t levelSize[2] = {queue[0]->size() - head[0], queue[1]->size() - head[1]};
+        if (levelSize[0] == 0 || levelSize[1] == 0)
+            throw std::runtime_error("target vertex is unreachable");
+        uint8_t side = levelSize[0] <= levelSize[1] ? 0 : 1;
+        auto& front = *queue[side];
+        const auto& other = *queue[1 - side];
+        std::size_t levelEnd = front.size();
+        while (head[side] < levelEnd)
+        {
+            Index cur = front[head[side]++];
+            visitOrder.push_back(cur);
+
+            // помечаем концы удалённых рёбер: метка действительна только для текущей вершины
+            work.nextMark();
+            for (auto elem : m_pGraph->neighbors(cur))
+                work.mark(elem);
+
+            // ребро к текущему уровню другой стороны есть, если не все его вершины помечены
+            for (std::size_t i = head[1 - side]; i < other.size(); ++i)
+                if (!work.isMarked(other[i]))
+                {
+                    setMeeting(side, cur, other[i]);
+                    return;
+                }
+
+            Index prevInList = listEnd;
+            for (Index i = unvisitedNext[listEnd]; i != listEnd; i = unvisitedNext[i])
+            {
+                if (work.isMarked(i)) //< ребро удалено, вершина остаётся в списке
+                {
+                    prevInList = i;
+                    continue;
+                }
+                front.push_back(i);
+                unvisitedNext[prevInList] = unvisitedNext[i];
+                work.setPrev(i, cur);
+            }
+        }
+    }
+}
+
+template<class Index>
+void BasicTraverser<Index>::traverseBidirMatrix(Index from, Index to)
+{
+    auto& work = *m_pWork;
+    auto& visitOrder = work.visitOrder();
+    const std::size_t words = m_pMatrix->rowWords();
+    if (startBidir(from, to))
+        return;
+    work.clearBits(words);
+    uint64_t* visited[2] = {work.visitBits(0), work.visitBits(1)};
+
+    List<Index>* queue[2] = {&work.sideFrontier(0), &work.sideFrontier(1)};
+    std::size_t head[2] = {0, 0};
+    queue[0]->push_back(from);
+    queue[1]->push_back(to);
+    visited[0][from / 64] |= uint64_t(1) << (from % 64);
+    visited[1][to / 64] |= uint64_t(1) << (to % 64);
+
+    while (true)
+    {
+        std::size_t levelSize[2] = {queue[0]->size() - head[0], queue[1]->size() - head[1]};
+        if (levelSize[0] == 0 || levelSize[1] == 0)
+            throw std::runtime_error("target vertex is unreachable");
+        uint8_t side = levelSize[0] <= levelSize[1] ? 0 : 1;
+        auto& front = *queue[side];
+        uint64_t* own = visited[side];
+        const uint64_t* other = visited[1 - side];
+        std::size_t levelEnd = front.size();
+        while (head[side] < levelEnd)
+        {
+            Index cur = front[head[side]++];
+            visitOrder.push_back(cur);
+            const uint64_t* row = m_pMatrix->row(cur);
+            // слово за словом, как CSR-обход по возрастанию соседей: сначала встреча, затем новые вершины
+            for (std::size_t w = 0; w < words; ++w)
+            {
+                if (uint64_t meet = row[w] & other[w])
+                {
+                    setMeeting(side, cur, static_cast<Index>(w * 64 + __builtin_ctzll(meet)));
+                    return;
+                }
+                uint64_t bits = row[w] & ~own[w];
+                own[w] |= bits;
+                for (; bits != 0; bits &= bits - 1)
+                {
+                    Index elem = static_cast<Index>(w * 64 + __builtin_ctzll(bits));
+                    front.push_back(elem);
+                    work.setPrev(elem, cur);
+                }
+            }
+        }
+    }
+}
+
+template<class Index>
+void BasicTraverser<Index>::traverseBidir(Index from, Index to, double density)
+{
+    if (m_pMatrix != nullptr)
+        traverseBidirMatrix(from, to);
+    else if (density >= MIN_INVERSE_DENSITY)
+        traverseBidirInv(from, to);
+    else
+        traverseBidir(from, to);
+}
+
 // Шаблонный метод traverseRand
+template<class Index>
 template <class StorageType>
-void Traverser::traverseRand(double density)
+void BasicTraverser<Index>::traverseRand(double density, Randomizer& rand)
 {
-    Randomizer rand;
-    SizeType from = rand.uRand(0, m_pNodes->size() - 1);
-    SizeType to = from;
+    Index from = rand.uRand(0, graphSize() - 1);
+    Index to = from;
     while (from == to)
-        to = rand.uRand(0, m_pNodes->size() - 1);
+        to = rand.uRand(0, graphSize() - 1);
     
     traverse<StorageType>(from, to, density);
 }
 
 // Метод getTraverseOrder
-const List<SizeType>& Traverser::getTraverseOrder()
+template<class Index>
+template <class StorageType>
+void BasicTraverser<Index>::traverseAll(Index from, double density)
+{
+    traverse<StorageType>(from, graphSize(), density);
+}
+
+template<class Index>
+const List<Index>& BasicTraverser<Index>::getTraverseOrder()
 {
-    return m_visitOrder;
+    return m_pWork->visitOrder();
 }
 
-SizeType Traverser::getFirst()
+template<class Index>
+Index BasicTraverser<Index>::getFirst()
 {
-    return *m_visitOrder.begin();
+    return *m_pWork->visitOrder().begin();
 }
 
-SizeType Traverser::getLast()
+template<class Index>
+Index BasicTraverser<Index>::getLast()
 {
-    return m_visitOrder.back();
+    return m_pWork->visitOrder().back();
+}
+
+template<class Index>
+Index BasicTraverser<Index>::getPrev(Index v)
+{
+    return m_pWork->prev(v);
 }
 
 // Метод getPath
-List<SizeType> Traverser::getPath()
+template<class Index>
+List<Index> BasicTraverser<Index>::getPath()
 {
-    SizeType cur = m_visitOrder.back();
-    List<SizeType> path{cur};
-    while (m_prev.count(cur))
+    if (m_bidir)
     {
-        cur = m_prev[cur];
+        // путь собирается из двух половин: от to до точки встречи и от точки встречи до from
+        List<Index> path;
+        if (m_meetTo != m_meetFrom)
+        {
+            for (Index cur = m_meetTo; cur != m_to; cur = m_pWork->prev(cur))
+                path.push_back(cur);
+            path.push_back(m_to);
+            std::reverse(path.begin(), path.end());
+        }
+        for (Index cur = m_meetFrom; ; cur = m_pWork->prev(cur))
+        {
+            path.push_back(cur);
+            if (cur == m_from)
+                break;
+        }
+        return path;
+    }
+
+    Index cur = getLast();
+    List<Index> path{cur};
+    while (cur != m_from)
+    {
+        cur = m_pWork->prev(cur);
         path.push_back(cur);
     }
     return path;
 }
 
-// Метод clear
-void Traverser::clear()
+template<class Index>
+Index BasicTraverser<Index>::getDistance()
 {
-    m_visited.clear();
-    m_prev.clear();
-    m_visitOrder.clear();
+    Index dist = 0;
+    if (m_bidir)
+    {
+        if (m_meetTo == m_meetFrom)
+            return 0;
+        for (Index cur = m_meetFrom; cur != m_from; cur = m_pWork->prev(cur))
+            ++dist;
+        for (Index cur = m_meetTo; cur != m_to; cur = m_pWork->prev(cur))
+            ++dist;
+        return dist + 1; //< само ребро встречи
+    }
+    for (Index cur = getLast(); cur != m_from; cur = m_pWork->prev(cur))
+        ++dist;
+    return dist;
 }
 
-// ========== Реализация метода extractElem ==========
-
-/// Специализация для std::queue
-template<>
-SizeType Traverser::extractElem(std::queue<SizeType>& storage)
+// Метод clear
+template<class Index>
+void BasicTraverser<Index>::clear()
 {
-    SizeType elem = storage.front();
-    storage.pop();
-    return elem;
+    m_pWork->reset();
 }
 
-// Специализация для std::stack
-template<>
-SizeType Traverser::extractElem(std::stack<SizeType>& storage)
-{
-    SizeType elem = storage.top();
-    storage.pop();
-    return elem;
-}
+// ========== Реализация метода extractElem ==========
 
-// Общая версия extractElem (для неподдерживаемых типов)
+// std::queue извлекает из головы массива, std::stack -- с конца
+template<class Index>
 template<class StorageType>
-SizeType Traverser::extractElem(StorageType& storage)
+Index BasicTraverser<Index>::extractElem()
 {
-    throw std::logic_error("extractElem is not specialized for this type");
+    if constexpr (std::is_same_v<StorageType, std::queue<Index>>)
+        return m_pWork->popFront();
+    else if constexpr (std::is_same_v<StorageType, std::stack<Index>>)
+        return m_pWork->popBack();
+    else // неподдерживаемый тип СД
+        throw std::logic_error("extractElem is not specialized for this type");
 }
 
 
-template void Traverser::traverse<class std::queue<SizeType>>(SizeType from, SizeType to, double);
-template void Traverser::traverse<class std::stack<SizeType>>(SizeType from, SizeType to, double);
\ No newline at end of file
+template class BasicTraverser<SizeType>;
+template class BasicTraverser<WideSizeType>;
+template void BasicTraverser<SizeType>::traverse<std::queue<SizeType>>(SizeType from, SizeType to, double);
+template void BasicTraverser<SizeType>::traverse<std::stack<SizeType>>(SizeType from, SizeType to, double);
+template void BasicTraverser<WideSizeType>::traverse<std::queue<WideSizeType>>(WideSizeType from, WideSizeType to, double);
+template void BasicTraverser<WideSizeType>::traverse<std::stack<WideSizeType>>(WideSizeType from, WideSizeType to, double);
+template void BasicTraverser<SizeType>::traverseAll<std::queue<SizeType>>(SizeType from, double);
+template void BasicTraverser<SizeType>::traverseAll<std::stack<SizeType>>(SizeType from, double);
+template void BasicTraverser<WideSizeType>::traverseAll<std::queue<WideSizeType>>(WideSizeType from, double);
+template void BasicTraverser<WideSizeType>::traverseAll<std::stack<WideSizeType>>(WideSizeType from, double);
@@ -5,15 +5,61 @@
 #include <stack>
 #include <queue>
 
-#include "graph/node.h"
+#include <memory>
+
+#include "graph/bit_matrix.h"
+#include "graph/csr.h"
+#include "graph/workspace.h"
 #include "randomizer/rand.h"
 
-class Traverser
+/**
+ * Когда поиск в ширину с выбором направления (traverseHybrid) переключается между шагами
+ *
+ * @details
+ *      В случайных графах степени вершин почти равны, поэтому объёмы работы шагов сравниваются
+ *      по числу вершин: сверху вниз просматриваются рёбра фронта, снизу вверх -- рёбра непосещённых.
+ *      Шаг сверху вниз останавливается, как только цель попала в очередь, а шаг снизу вверх должен
+ *      найти родителей всех вершин уровня, поэтому снизу вверх выгодно идти только на уровнях,
+ *      заметно больших остатка графа (на случайных графах от 6000 вершин лучшее alpha -- около 0.25).
+ */
+struct DirectionHeuristic
+{
+    double alpha = 0.25;    // Снизу вверх, когда фронт больше (число непосещённых) / alpha
+    double beta = 24;    // Обратно сверху вниз, когда фронт меньше n / beta
+};
+
+/**
+ * Обходы графа между двумя вершинами (поиск в ширину, в глубину и двунаправленный)
+ *
+ * @details
+ *      Граф задаётся в CSR или битовой матрицей. Обходы матрицы раскрывают вершину просмотром
+ *      её строки против битового множества посещённых; соседи выдаются по возрастанию, поэтому
+ *      порядок обхода тот же, что и на CSR того же графа (в том числе на хранимом дополнении).
+ *
+ * @tparam Index тип номера вершины
+ */
+template<class Index>
+class BasicTraverser
 {
 public:
-    // указатель, чтобы не копировать список
-    Traverser(List<Node>* nodes) : m_pNodes(nodes)
-    {} //< вероятно, имеет смысл зарезервировать место для некоторого числа вершин во вспомогательных структурах 
+    using Graph = BasicCsrGraph<Index>;
+    using Workspace = BasicTraversalWorkspace<Index>;
+    using Matrix = BasicBitMatrixGraph<Index>;
+
+    // указатель, чтобы не копировать граф; рабочая память выделяется под этот обходчик
+    BasicTraverser(const Graph* graph);
+
+    /**
+     * Обходчик, использующий внешнюю рабочую память
+     *
+     * @param graph граф для обхода
+     * @param workspace рабочая память, которая переживает обходчик и переиспользуется между поисками
+     *                  (перевыделяется, только если изменился размер графа)
+     */
+    BasicTraverser(const Graph* graph, Workspace* workspace);
+
+    // Обходчик графа, заданного битовой матрицей (плотность при обходе роли не играет)
+    BasicTraverser(const Matrix* matrix, Workspace* workspace);
 
     /**
      * Функция для обхода графа между двумя заданными вершинами
@@ -23,7 +69,7 @@ public:
      * @param to конечная вершина
      */
     template <class StorageType>
-    void traverse(SizeType from, SizeType to);
+    void traverse(Index from, Index to);
 
     /**
      * Функция для обхода графа с заданной плотностью
@@ -34,52 +80,164 @@ public:
      * @param density плотность графа: в случае большой плотности будет выбран инвертированный обход
      */
     template <class StorageType>
-    void traverse(SizeType from, SizeType to, double density);
+    void traverse(Index from, Index to, double density);
+
+    /**
+     * Полный обход из from: в порядок обхода попадают все достижимые вершины
+     *
+     * @details
+     *      Обход traverse(from, to) извлекает вершины в том же порядке и останавливается на to,
+     *      поэтому его порядок -- начало полного порядка до to включительно (см. BasicOrderCache).
+     *
+     * @tparam StorageType тип стека или очереди, используемый для хранения порядка обхода
+     * @param from начальная вершина
+     * @param density плотность графа: в случае большой плотности будет выбран инвертированный обход
+     */
+    template <class StorageType>
+    void traverseAll(Index from, double density);
 
-        /**
+    /**
      * Функция для обхода инвертированного графа между двумя заданными вершинами
+     *
+     * @details
+     *      Граф задан удалёнными рёбрами. Вместо перебора всех n вершин на каждом шаге
+     *      обход проходит только по ещё не посещённым вершинам и удалённым рёбрам,
+     *      поэтому стоит O(n + число удалённых рёбер) и посещает вершины в том же порядке.
      * 
      * @tparam StorageType тип стека или очереди, используемый для хранения порядка обхода
      * @param from начальная вершина
      * @param to конечная вершина
      */
     template <class StorageType>
-    void traverseInv(SizeType from, SizeType to);
+    void traverseInv(Index from, Index to);
+
+    /**
+     * Поиск в ширину с выбором направления шага (сверху вниз или снизу вверх, по Бимеру)
+     *
+     * @details
+     *      Поиск идёт по уровням. Шаг сверху вниз раскрывает вершины фронта по порядку, как traverse.
+     *      Шаг снизу вверх перебирает непосещённые вершины и для каждой ищет соседа во фронте; он
+     *      выгоднее, когда фронт охватывает большую часть графа. Родителем берётся сосед с наименьшим
+     *      местом в очереди, а новые вершины упорядочиваются по месту родителя и номеру -- ровно так
+     *      их поставил бы в очередь traverse<std::queue>. Поэтому порядок обхода (число посещённых
+     *      вершин), предки и путь совпадают с обычным поиском в ширину.
+     *
+     * @param from начальная вершина
+     * @param to конечная вершина
+     * @param density плотность графа: в случае большой плотности обходится дополнение
+     * @param heuristic пороги переключения направления
+     * @throw std::runtime_error если вершины не связаны
+     */
+    void traverseHybrid(Index from, Index to, double density,
+                        const DirectionHeuristic& heuristic = DirectionHeuristic());
+
+    /**
+     * Двунаправленный поиск в ширину между двумя заданными вершинами
+     *
+     * @details
+     *      Фронты растут одновременно от from и от to; каждый шаг раскрывает целый уровень
+     *      меньшего из фронтов. Поиск останавливается на первом ребре между сторонами: все
+     *      вершины, посещённые другой стороной раньше её текущего уровня, уже раскрыты, поэтому
+     *      первое найденное ребро лежит на кратчайшем пути. Порядок обхода содержит раскрытые
+     *      вершины обеих сторон, getPath и getDistance возвращают кратчайший путь.
+     *
+     * @param from начальная вершина
+     * @param to конечная вершина
+     * @throw std::runtime_error если вершины не связаны
+     */
+    void traverseBidir(Index from, Index to);
+
+    /**
+     * Двунаправленный поиск в ширину с учётом плотности графа
+     *
+     * @param from начальная вершина
+     * @param to конечная вершина
+     * @param density плотность графа: в случае большой плотности будет выбран инвертированный обход
+     */
+    void traverseBidir(Index from, Index to, double density);
+
+    /**
+     * Двунаправленный поиск в ширину по инвертированному графу
+     *
+     * @details
+     *      Новые вершины берутся из общего списка непосещённых, как в traverseInv. Встреча ищется
+     *      среди текущего уровня другой стороны: пропускаемые вершины связаны с раскрываемой
+     *      удалённым ребром, поэтому раскрытие вершины стоит O(1 + число её удалённых рёбер).
+     *
+     * @param from начальная вершина
+     * @param to конечная вершина
+     */
+    void traverseBidirInv(Index from, Index to);
 
     /**
      * Генерирует случайный путь между двумя случайными вершинами
      * 
      * @tparam StorageType тип стека или очереди, используемый для хранения порядка обхода
+     * @param density плотность графа
+     * @param rand генератор, из которого выбираются концы пути
      */
     template <class StorageType>
-    void traverseRand(double density);
+    void traverseRand(double density, Randomizer& rand);
 
     // Позволяет восстановить начало и конец маршрута: первая вершина — откуда начали, последняя вершина — куда пришли.
-    const List<SizeType>& getTraverseOrder();
+    const List<Index>& getTraverseOrder();
 
     // Позволяет установить расстояние между вершинами для обхода в ширину.
     // Для этого переходим в предыдущую вершину, пока не окажемся в первой. 
-    List<SizeType> getPath();
+    List<Index> getPath();
+
+    // Длина найденного пути (число рёбер) без построения самого пути
+    Index getDistance();
 
-    SizeType getFirst();
+    Index getFirst();
 
-    SizeType getLast();
+    Index getLast();
 
-    // очистка всех СД для запуска нового обхода
+    // Предок вершины в дереве последнего обхода (имеет смысл для посещённых вершин, кроме начальной)
+    Index getPrev(Index v);
+
+    // очистка всех СД для запуска нового обхода (за O(1))
     void clear();
 
 private:
-    // у стека и очереди разные интерфейсы, поэтому завернул извлечение элемента в специализированный шаблон
+    // Тип СД (std::queue или std::stack) задаёт лишь порядок извлечения,
+    // сами вершины лежат в массиве рабочей памяти; извлечение выбирается по типу СД
     template<class StorageType>
-    SizeType extractElem(StorageType& storage);
+    Index extractElem();
+
+    // true, если очередь или стек опустели при полном обходе (to == graphSize());
+    // при поиске конкретной вершины это значит, что она недостижима (std::runtime_error)
+    bool frontierExhausted(Index to) const;
+
+    // Подготовка двунаправленного поиска; true, если концы совпадают и искать нечего
+    bool startBidir(Index from, Index to);
 
-    List<Node>* m_pNodes;
-    Set<SizeType> m_visited;
-    Map<SizeType, SizeType> m_prev;
-    List<SizeType> m_visitOrder;
+    // Поиск в ширину по уровням с выбором направления; levels -- шаги для представления графа
+    template<class Levels>
+    void traverseLevels(Index from, Index to, Levels& levels, const DirectionHeuristic& heuristic);
+
+    // Обход и двунаправленный поиск по битовой матрице m_pMatrix
+    template<class StorageType>
+    void traverseMatrix(Index from, Index to);
+    void traverseBidirMatrix(Index from, Index to);
+
+    // Количество вершин графа в любом представлении
+    Index graphSize() const;
+
+    // Запоминает ребро встречи: cur раскрывался стороной side, elem посещён другой стороной
+    void setMeeting(uint8_t side, Index cur, Index elem);
+
+    const Graph* m_pGraph = nullptr;
+    const Matrix* m_pMatrix = nullptr;     //< граф задан битовой матрицей (m_pGraph не используется)
+    Workspace* m_pWork;
+    std::unique_ptr<Workspace> m_ownWork;  //< рабочая память, если внешняя не передана
+    Index m_from = 0;                      //< начало последнего обхода
+    Index m_to = 0;                        //< конец последнего двунаправленного обхода
+    bool m_bidir = false;                  //< последний обход был двунаправленным
+    Index m_meetFrom = 0;                  //< конец ребра встречи со стороны from
+    Index m_meetTo = 0;                    //< конец ребра встречи со стороны to
 };
 
-//template<class StorageType> void
-//Traverser::traverse(SizeType from, SizeType to, double density);
+using Traverser = BasicTraverser<SizeType>;
 
 #endif // TRAVERSAL_H
\ No newline at end of file
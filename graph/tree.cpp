@@ -1,23 +1,26 @@
 #include "tree.h"
 #include "randomizer/rand.h"
 
-List<Node> get_tree(SizeType size)
+template<class Index>
+List<BasicNode<Index>> get_tree(Index size, Randomizer& rand)
 {
 	if (size == 0)
 		return {};
 
-	Randomizer rand;
-	List<Node> nodes;
+	List<BasicNode<Index>> nodes;
 	nodes.reserve(size); // Резервируем память под узлы
-	nodes.push_back(Node(0, Set<SizeType>{})); // Корневой узел
+	nodes.push_back(BasicNode<Index>(0, Set<Index>{})); // Корневой узел
 
 	// Создание дерева
-	for (SizeType i = 1; i < size; ++i)
+	for (Index i = 1; i < size; ++i)
 	{
-		SizeType ancestorNode = rand.uRand(0, i - 1); // Выбираем случайного предка
-		nodes.push_back(Node(i, Set<SizeType>{ancestorNode})); // "подвешиваем" к предку
+		Index ancestorNode = rand.uRand(0, i - 1); // Выбираем случайного предка
+		nodes.push_back(BasicNode<Index>(i, Set<Index>{ancestorNode})); // "подвешиваем" к предку
 		nodes[ancestorNode].incident.insert(i); // Добавляем связь от предка
 	}
 
 	return nodes;
 }
+
+template List<BasicNode<SizeType>> get_tree(SizeType size, Randomizer& rand);
+template List<BasicNode<WideSizeType>> get_tree(WideSizeType size, Randomizer& rand);
@@ -3,8 +3,10 @@
 #define TREE_H
 
 #include "graph/node.h"
+#include "randomizer/rand.h"
 
 // Функция для генерации рекурсивного случайного дерева
-List<Node> get_tree(SizeType size);
+template<class Index>
+List<BasicNode<Index>> get_tree(Index size, Randomizer& rand);
 
 #endif // TREE_H
\ No newline at end of file
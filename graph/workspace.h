@@ -0,0 +1,153 @@
+#pragma once
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <cstddef>
+#include <algorithm>
+
+#include "common/common.h"
+
+/**
+ * Рабочая память обходов графа, переиспользуемая между поисками и графами.
+ *
+ * @details
+ *      Вместо хеш-множества посещённых вершин и хеш-таблицы предков хранятся плотные массивы,
+ *      индексируемые номером вершины. Вершина считается посещённой, если её метка совпадает
+ *      с номером текущего поколения, поэтому сброс перед новым обходом -- это увеличение счётчика.
+ *      Память выделяется один раз на размер графа (reserve) и дальше не перераспределяется.
+ *
+ * @tparam Index тип номера вершины
+ */
+template<class Index>
+class BasicTraversalWorkspace
+{
+public:
+    /**
+     * Готовит массивы под граф на n вершинах; при неизменном n ничего не делает
+     *
+     * @param n количество вершин
+     */
+    void reserve(Index n)
+    {
+        if (m_visitStamp.size() == n)
+            return;
+        m_visitStamp.assign(n, 0);
+        m_markStamp.assign(n, 0);
+        m_prev.assign(n, 0);
+        m_position.assign(n, 0);
+        m_unvisitedNext.assign(static_cast<std::size_t>(n) + 1, 0);
+        m_side.assign(n, 0);
+        m_visitOrder.reserve(n);
+        m_frontier.reserve(n);
+        m_backFrontier.reserve(n);
+        m_epoch = 0;
+        m_markEpoch = 0;
+        reset();
+    }
+
+    // Начинает новое поколение: все вершины становятся непосещёнными за O(1)
+    void reset()
+    {
+        if (++m_epoch == 0) //< счётчик переполнился: метки прошлых поколений могут совпасть
+        {
+            std::fill(m_visitStamp.begin(), m_visitStamp.end(), 0);
+            m_epoch = 1;
+        }
+        m_visitOrder.clear();
+        m_frontier.clear();
+        m_backFrontier.clear();
+        m_head = 0;
+    }
+
+    bool isVisited(Index v) const { return m_visitStamp[v] == m_epoch; }
+    void markVisited(Index v) { m_visitStamp[v] = m_epoch; }
+
+    // Посещение вершины одной из сторон двунаправленного поиска (0 -- от начала, 1 -- от конца)
+    void markVisited(Index v, uint8_t side)
+    {
+        m_visitStamp[v] = m_epoch;
+        m_side[v] = side;
+    }
+    // Сторона, посетившая вершину (имеет смысл, только если isVisited(v))
+    uint8_t side(Index v) const { return m_side[v]; }
+
+    Index prev(Index v) const { return m_prev[v]; }
+    void setPrev(Index v, Index from) { m_prev[v] = from; }
+
+    // Место вершины в очереди обхода по уровням (имеет смысл, только если вершина посещена)
+    Index position(Index v) const { return m_position[v]; }
+    void setPosition(Index v, Index position) { m_position[v] = position; }
+
+    // Буферы шага снизу вверх: новые вершины уровня, места их родителей в уровне и счётчики сортировки
+    List<Index>& foundVertices() { return m_foundVertices; }
+    List<Index>& foundParents() { return m_foundParents; }
+    List<Index>& parentCounts() { return m_parentCounts; }
+
+    // Метки для одной раскрываемой вершины: новый номер делает недействительными все старые
+    void nextMark()
+    {
+        if (++m_markEpoch == 0)
+        {
+            std::fill(m_markStamp.begin(), m_markStamp.end(), 0);
+            m_markEpoch = 1;
+        }
+    }
+    bool isMarked(Index v) const { return m_markStamp[v] == m_markEpoch; }
+    void mark(Index v) { m_markStamp[v] = m_markEpoch; }
+
+    // Порядок, в котором вершины извлекались из очереди или стека
+    List<Index>& visitOrder() { return m_visitOrder; }
+
+    // Очередь/стек обхода в одном массиве: каждая вершина попадает в него не более одного раза
+    void push(Index v) { m_frontier.push_back(v); }
+    bool frontierEmpty() const { return m_head == m_frontier.size(); }
+    Index popFront() { return m_frontier[m_head++]; }
+    Index popBack()
+    {
+        Index v = m_frontier.back();
+        m_frontier.pop_back();
+        return v;
+    }
+
+    // Очередь стороны двунаправленного поиска: 0 -- от начала (общая с push/popFront), 1 -- от конца
+    List<Index>& sideFrontier(uint8_t side) { return side == 0 ? m_frontier : m_backFrontier; }
+
+    // Односвязный список непосещённых вершин для обхода дополнения графа
+    List<Index>& unvisitedNext() { return m_unvisitedNext; }
+
+    /**
+     * Обнуляет битовые множества посещённых вершин для обхода битовой матрицы
+     *
+     * @param words длина строки матрицы в словах (память выделяется один раз на размер строки)
+     */
+    void clearBits(std::size_t words)
+    {
+        for (auto& bits : m_visitBits)
+            bits.assign(words, 0);
+    }
+
+    // Вершины, посещённые стороной side (обычные обходы используют сторону 0)
+    uint64_t* visitBits(uint8_t side) { return m_visitBits[side].data(); }
+
+private:
+    List<uint32_t> m_visitStamp;     // Поколение, в котором вершина была посещена
+    List<uint32_t> m_markStamp;      // Метки концов удалённых рёбер раскрываемой вершины
+    List<uint8_t> m_side;            // Сторона двунаправленного поиска, посетившая вершину
+    List<Index> m_prev;              // Предок вершины в дереве обхода
+    List<Index> m_position;          // Место вершины в очереди обхода по уровням
+    List<Index> m_foundVertices;     // Новые вершины шага снизу вверх (по возрастанию номеров)
+    List<Index> m_foundParents;      // Место родителя каждой новой вершины в текущем уровне
+    List<Index> m_parentCounts;      // Счётчики сортировки новых вершин по месту родителя
+    List<Index> m_visitOrder;        // История обхода
+    List<Index> m_frontier;          // Очередь (с головой m_head) или стек обхода
+    List<Index> m_backFrontier;      // Очередь обратной стороны двунаправленного поиска
+    List<Index> m_unvisitedNext;     // Непосещённые вершины (n -- голова/конец списка)
+    List<uint64_t> m_visitBits[2];   // Посещённые вершины по сторонам (обходы битовой матрицы)
+    std::size_t m_head = 0;
+    uint32_t m_epoch = 0;
+    uint32_t m_markEpoch = 0;
+};
+
+using TraversalWorkspace = BasicTraversalWorkspace<SizeType>;
+
+#endif // WORKSPACE_H
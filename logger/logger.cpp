@@ -1,60 +1,128 @@
 #include <iostream>
 #include <filesystem>
+#include <stdexcept>
 
 #include "logger.h"
 
 
-Logger::Logger(const std::string& log, const std::string& err)
+Logger::Logger(const std::string& log, const std::string& err, const std::string& dist, bool append)
+    : m_logPath(log), m_distPath(dist)
 {
-    std::filesystem::path logPath(log);
-    if (std::filesystem::exists(log))
-        std::cerr << "log file exists" << std::endl;
-    m_log.open(logPath);
-    if (!m_log.is_open()) {
-        std::cerr << "Error opening log file." << std::endl;
+    const std::ios::openmode mode = append ? std::ios::app : std::ios::out;
+    if (!log.empty())
+    {
+        std::filesystem::path logPath(log);
+        if (std::filesystem::exists(log) && !append)
+            std::cerr << "log file exists" << std::endl;
+        m_log.open(logPath, mode);
+        if (!m_log.is_open()) {
+            std::cerr << "Error opening log file." << std::endl;
+        }
     }
     std::filesystem::path errPath(err);
-    if (std::filesystem::exists(errPath))
+    if (std::filesystem::exists(errPath) && !append)
         std::cerr << "log file exists" << std::endl;
-    m_err.open(errPath);
+    m_err.open(errPath, mode);
     if (!m_err.is_open()) {
         std::cerr << "Error opening log file." << std::endl;
     }
+    if (!dist.empty())
+    {
+        m_dist.open(dist, mode);
+        if (!m_dist.is_open()) {
+            std::cerr << "Error opening log file." << std::endl;
+        }
+    }
 }
 
 Logger::~Logger()
 {
     m_log.close();
     m_err.close();
+    m_dist.close();
+}
+
+Logger::Sizes Logger::flush()
+{
+    m_log.flush();
+    m_err.flush();
+    m_dist.flush();
+    Sizes sizes;
+    if (m_log.is_open())
+        sizes.log = std::filesystem::file_size(m_logPath);
+    if (m_dist.is_open())
+        sizes.dist = std::filesystem::file_size(m_distPath);
+    return sizes;
+}
+
+void Logger::truncate(const Sizes& sizes)
+{
+    // файлы открыты на дозапись, поэтому следующая строка ляжет сразу за обрезанным концом
+    Sizes current = flush();
+    if (current.log < sizes.log || current.dist < sizes.dist)
+        throw std::runtime_error("log is shorter than the checkpoint");
+    if (m_log.is_open())
+        std::filesystem::resize_file(m_logPath, sizes.log);
+    if (m_dist.is_open())
+        std::filesystem::resize_file(m_distPath, sizes.dist);
 }
 
-void Logger::errSearch(const std::string& errTxt, SizeType graphSize, double density, SizeType from, SizeType to,
+void Logger::errSearch(const std::string& errTxt, uint32_t graphSize, double density, uint32_t from, uint32_t to,
                        const std::string& searchType)
 {
     m_err << "Error while " << searchType << " searching graph on " << graphSize
           << " vertices from " << from << " to " << to << " with density " << density << ": " << errTxt << std::endl;
 }
 
-void Logger::logErrGraph(const List<Node>& graph)
+template<class Index>
+void Logger::logErrGraph(const BasicCsrGraph<Index>& graph)
 {
     m_err << "graph representaion: <n = num of incident verts> <v1> <v2> ... <vn>" << std::endl;
-    for (const Node& node : graph)
+    for (Index v = 0; v < graph.size(); ++v)
     {
-        m_err << node.incident.size() << ' ';
-        for (SizeType inc : node.incident)
+        m_err << graph.degree(v) << ' ';
+        for (Index inc : graph.neighbors(v))
         m_err << inc << ' ';
         m_err << std::endl;
     }
 }
 
-void Logger::errBuild(const std::string& errTxt, SizeType graphSize, double density)
+template<class Index>
+void Logger::logErrGraph(const BasicBitMatrixGraph<Index>& graph)
+{
+    m_err << "graph representaion: <n = num of incident verts> <v1> <v2> ... <vn>" << std::endl;
+    for (Index v = 0; v < graph.size(); ++v)
+    {
+        m_err << graph.degree(v) << ' ';
+        graph.forEachNeighbor(v, [this](Index inc) { m_err << inc << ' '; });
+        m_err << std::endl;
+    }
+}
+
+void Logger::errBuild(const std::string& errTxt, uint32_t graphSize, double density)
 {
     m_err << "Error while building graph on " << graphSize
           << " vertices with density " << density << ": " << errTxt << std::endl;
 }
 
-void Logger::log(SizeType graphSize, double density, SizeType dist, SizeType bfs, SizeType dfs)
+void Logger::log(uint32_t graphSize, double density, uint32_t dist, const List<int>& visited)
 {
     // пока лог упоротый, но зато отдельные части независимы
-    m_log << graphSize << ' ' << density << ' ' << dist << ' ' << bfs << ' ' << dfs << std::endl;
-}
\ No newline at end of file
+    m_log << graphSize << ' ' << density << ' ' << dist;
+    for (int count : visited)
+        m_log << ' ' << count;
+    m_log << '\n'; //< без сброса на каждой строке: поток пишет большими порциями
+
+}
+void Logger::logDistances(uint32_t graphSize, double density, const List<uint64_t>& pairs)
+{
+    m_dist << graphSize << ' ' << density;
+    for (std::size_t d = 1; d < pairs.size(); ++d)
+        m_dist << ' ' << pairs[d];
+    m_dist << '\n';
+}
+
+template void Logger::logErrGraph(const BasicCsrGraph<SizeType>& graph);
+template void Logger::logErrGraph(const BasicCsrGraph<WideSizeType>& graph);
+template void Logger::logErrGraph(const BasicBitMatrixGraph<SizeType>& graph);
+template void Logger::logErrGraph(const BasicBitMatrixGraph<WideSizeType>& graph);
@@ -6,22 +6,53 @@
 #include <string>
 
 #include "common/common.h"
-#include "graph/node.h"
+#include "graph/bit_matrix.h"
+#include "graph/csr.h"
 
 class Logger
 {
 public:
-    Logger(const std::string& log, const std::string& err);
+    // Размеры файлов лога и распределений, байт
+    struct Sizes
+    {
+        uint64_t log = 0;
+        uint64_t dist = 0;
+    };
+
+    // log -- текстовый лог поисков, dist -- файл распределений расстояний; пустой путь -- файл не пишется.
+    // При append файлы дописываются, а не перезаписываются (продолжение с контрольной точки)
+    Logger(const std::string& log, const std::string& err, const std::string& dist = "", bool append = false);
     ~Logger();
 
-    void errSearch(const std::string& errTxt, SizeType graphSize, double density, SizeType from, SizeType to,
+    // Сбрасывает все файлы на диск и возвращает размеры лога и распределений
+    Sizes flush();
+
+    /**
+     * Обрезает лог и распределения до размеров sizes: запись продолжится с этого места
+     * (логгер должен быть открыт с append)
+     *
+     * @throw std::runtime_error если файл короче, чем sizes (вывод потерян)
+     */
+    void truncate(const Sizes& sizes);
+
+    // Размеры графов и номера вершин принимаются в uint32_t -- подходят для любого типа номера вершины
+    void errSearch(const std::string& errTxt, uint32_t graphSize, double density, uint32_t from, uint32_t to,
                    const std::string& searchType);
-    void logErrGraph(const List<Node>& graph);
-    void errBuild(const std::string& errTxt, SizeType graphSize, double density);
-    void log(SizeType graphSize, double density, SizeType dist, SizeType bfs, SizeType dfs);
+    template<class Index>
+    void logErrGraph(const BasicCsrGraph<Index>& graph);
+    template<class Index>
+    void logErrGraph(const BasicBitMatrixGraph<Index>& graph);
+    void errBuild(const std::string& errTxt, uint32_t graphSize, double density);
+    // Строка лога: размер графа, плотность, расстояние и число посещённых вершин каждым методом поиска
+    void log(uint32_t graphSize, double density, uint32_t dist, const List<int>& visited);
+    // Строка распределения расстояний графа: размер, плотность и число пар на расстоянии 1, 2, ...
+    void logDistances(uint32_t graphSize, double density, const List<uint64_t>& pairs);
 private:
+    std::string m_logPath;
+    std::string m_distPath;
     std::ofstream m_log;
     std::ofstream m_err;
+    std::ofstream m_dist;
 };
 
 
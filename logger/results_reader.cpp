@@ -0,0 +1,130 @@
+#include "results_reader.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace results_format;
+
+ResultsReader::ResultsReader(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Error opening file " + path);
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Error reading file " + path);
+    }
+    m_size = static_cast<std::size_t>(info.st_size);
+    if (m_size > 0)
+    {
+        void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Error mapping file " + path);
+        }
+        m_data = static_cast<const char*>(data);
+        ::madvise(data, m_size, MADV_SEQUENTIAL);
+    }
+    ::close(fd); //< отображение остаётся действительным и после закрытия файла
+
+    try
+    {
+        parse(path);
+    }
+    catch (...)
+    {
+        unmap();
+        throw;
+    }
+}
+
+void ResultsReader::parse(const std::string& path)
+{
+    // Заголовок со схемой
+    uint32_t header[2];
+    const std::size_t headerSize = sizeof(kMagic) + sizeof(header);
+    if (m_size < headerSize || std::memcmp(m_data, kMagic, sizeof(kMagic)) != 0)
+        throw std::runtime_error("Not a results file: " + path);
+    std::memcpy(header, m_data + sizeof(kMagic), sizeof(header));
+    std::size_t offset = headerSize;
+    const std::size_t columnSize = sizeof(uint32_t) + kNameSize;
+    if (m_size < offset + header[0] * columnSize)
+        throw std::runtime_error("Truncated results header: " + path);
+    for (uint32_t c = 0; c < header[0]; ++c, offset += columnSize)
+    {
+        uint32_t type;
+        std::memcpy(&type, m_data + offset, sizeof(type));
+        if (type != kUInt32 && type != kFloat64)
+            throw std::runtime_error("Unknown column type in " + path);
+        const char* name = m_data + offset + sizeof(type);
+        m_columns.push_back({std::string(name, strnlen(name, kNameSize)), static_cast<ColumnType>(type)});
+    }
+
+    // Оглавление блоков: строки считаем сразу, данные не трогаем
+    Block block;
+    while (offset < m_size)
+    {
+        m_blockOffsets.push_back(offset);
+        offset = readBlock(offset, block);
+        m_rows += block.rows;
+    }
+}
+
+ResultsReader::~ResultsReader()
+{
+    unmap();
+}
+
+void ResultsReader::unmap()
+{
+    if (m_data != nullptr)
+        ::munmap(const_cast<char*>(m_data), m_size);
+    m_data = nullptr;
+}
+
+const List<Column>& ResultsReader::columns() const
+{
+    return m_columns;
+}
+
+std::size_t ResultsReader::findColumn(const std::string& name) const
+{
+    for (std::size_t c = 0; c < m_columns.size(); ++c)
+        if (m_columns[c].name == name)
+            return c;
+    return m_columns.size();
+}
+
+std::size_t ResultsReader::rows() const
+{
+    return m_rows;
+}
+
+std::size_t ResultsReader::readBlock(std::size_t offset, Block& block) const
+{
+    uint32_t header[2];
+    if (offset + sizeof(header) > m_size)
+        throw std::runtime_error("Truncated results block");
+    std::memcpy(header, m_data + offset, sizeof(header));
+    offset += sizeof(header);
+
+    block.rows = header[0];
+    block.data.resize(m_columns.size());
+    for (std::size_t c = 0; c < m_columns.size(); ++c)
+    {
+        std::size_t bytes = columnBytes(m_columns[c].type, block.rows);
+        if (offset + bytes > m_size)
+            throw std::runtime_error("Truncated results block");
+        block.data[c] = m_data + offset;
+        offset += bytes;
+    }
+    return offset;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef RESULTS_READER_H
+#define RESULTS_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "common/common.h"
+#include "logger/results_writer.h"
+
+/**
+ * Чтение двоичного файла результатов (формат описан в results_writer.h).
+ *
+ * @details
+ *      Файл отображается в память целиком, блоки не копируются: столбцы блока отдаются
+ *      указателями прямо на отображённые страницы, а система подгружает их по мере чтения.
+ */
+class ResultsReader
+{
+public:
+    // Столбцы одного блока: data[c] указывает на rows значений столбца c
+    struct Block
+    {
+        std::size_t rows;
+        List<const char*> data;
+
+        uint32_t uint32At(std::size_t column, std::size_t row) const
+        {
+            return reinterpret_cast<const uint32_t*>(data[column])[row];
+        }
+        double float64At(std::size_t column, std::size_t row) const
+        {
+            return reinterpret_cast<const double*>(data[column])[row];
+        }
+    };
+
+    /**
+     * @param path файл результатов
+     * @throw std::runtime_error если файл не открывается или повреждён
+     */
+    explicit ResultsReader(const std::string& path);
+    ~ResultsReader();
+
+    ResultsReader(const ResultsReader&) = delete;
+    ResultsReader& operator=(const ResultsReader&) = delete;
+
+    const List<results_format::Column>& columns() const;
+
+    // Номер столбца по имени; columns().size(), если такого нет
+    std::size_t findColumn(const std::string& name) const;
+
+    // Общее число строк
+    std::size_t rows() const;
+
+    // Вызывает visit(const Block&) для каждого блока по порядку
+    template<class Visitor>
+    void forEachBlock(Visitor&& visit) const
+    {
+        Block block;
+        for (std::size_t offset : m_blockOffsets)
+        {
+            readBlock(offset, block);
+            visit(static_cast<const Block&>(block));
+        }
+    }
+
+private:
+    // Разбирает заголовок и составляет оглавление блоков
+    void parse(const std::string& path);
+
+    void unmap();
+
+    // Разбирает блок, начинающийся со смещения offset; возвращает смещение следующего блока
+    std::size_t readBlock(std::size_t offset, Block& block) const;
+
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    List<results_format::Column> m_columns;
+    List<std::size_t> m_blockOffsets;
+    std::size_t m_rows = 0;
+};
+
+#endif // RESULTS_READER_H
@@ -0,0 +1,173 @@
+#include "results_writer.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace results_format;
+
+ResultsWriter::ResultsWriter(const std::string& path, const List<Column>& columns, std::size_t blockRows,
+                             bool append)
+    : m_columns(columns), m_blockRows(blockRows == 0 ? 1 : blockRows)
+{
+    m_file.open(path, append ? std::ios::binary | std::ios::app : std::ios::binary);
+    if (!m_file)
+        throw std::runtime_error("Error opening file " + path);
+
+    // Заголовок со схемой (при дозаписи он уже в файле)
+    if (!append)
+    {
+        uint32_t header[2] = {static_cast<uint32_t>(m_columns.size()), 0};
+        m_file.write(kMagic, sizeof(kMagic));
+        m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        for (const auto& column : m_columns)
+        {
+            char name[kNameSize] = {};
+            std::strncpy(name, column.name.c_str(), kNameSize - 1);
+            uint32_t type = column.type;
+            m_file.write(reinterpret_cast<const char*>(&type), sizeof(type));
+            m_file.write(name, kNameSize);
+        }
+    }
+
+    for (auto& block : m_blocks)
+    {
+        block.columns.resize(m_columns.size());
+        for (std::size_t c = 0; c < m_columns.size(); ++c)
+            block.columns[c].resize(columnBytes(m_columns[c].type, m_blockRows));
+    }
+    m_thread = std::thread(&ResultsWriter::writerLoop, this);
+}
+
+ResultsWriter::~ResultsWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        // деструктор не бросает: ошибку можно получить, вызвав close() явно
+    }
+}
+
+char* ResultsWriter::nextValue(ColumnType type)
+{
+    if (m_column >= m_columns.size() || m_columns[m_column].type != type)
+        throw std::logic_error("value does not match the results schema");
+    Block& block = m_blocks[m_current];
+    return block.columns[m_column++].data() + block.rows * valueSize(type);
+}
+
+void ResultsWriter::push(uint32_t value)
+{
+    std::memcpy(nextValue(kUInt32), &value, sizeof(value));
+}
+
+void ResultsWriter::push(double value)
+{
+    std::memcpy(nextValue(kFloat64), &value, sizeof(value));
+}
+
+void ResultsWriter::endRow()
+{
+    if (m_column != m_columns.size())
+        throw std::logic_error("results row is incomplete");
+    m_column = 0;
+    if (++m_blocks[m_current].rows == m_blockRows)
+        submit();
+}
+
+void ResultsWriter::submit()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_error)
+        std::rethrow_exception(m_error);
+    // следующий блок должен быть свободен: ждём, пока фоновый поток не запишет самый старый
+    m_freed.wait(lock, [this] { return m_queued + 1 < kBlocks || m_error; });
+    if (m_error)
+        std::rethrow_exception(m_error);
+    ++m_queued;
+    m_current = (m_current + 1) % kBlocks;
+    m_blocks[m_current].rows = 0;
+    m_ready.notify_one();
+}
+
+void ResultsWriter::flush()
+{
+    if (m_blocks[m_current].rows > 0)
+        submit();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_freed.wait(lock, [this] { return m_queued == 0 || m_error; });
+    if (m_error)
+        std::rethrow_exception(m_error);
+    // фоновый поток простаивает, пока очередь пуста
+    m_file.flush();
+    if (!m_file)
+        throw std::runtime_error("Error writing results file");
+}
+
+void ResultsWriter::close()
+{
+    if (m_closed)
+        return;
+    m_closed = true;
+    if (m_blocks[m_current].rows > 0)
+        submit();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_ready.notify_one();
+    m_thread.join();
+    m_file.close();
+    if (m_error)
+        std::rethrow_exception(m_error);
+}
+
+void ResultsWriter::writerLoop()
+{
+    while (true)
+    {
+        std::size_t index;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_ready.wait(lock, [this] { return m_queued > 0 || m_stop; });
+            if (m_queued == 0)
+                return;
+            index = (m_current + kBlocks - m_queued) % kBlocks; //< самый старый из ждущих блоков
+        }
+
+        try
+        {
+            writeBlock(m_blocks[index]);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_queued;
+        }
+        m_freed.notify_one();
+    }
+}
+
+void ResultsWriter::writeBlock(const Block& block)
+{
+    uint32_t header[2] = {static_cast<uint32_t>(block.rows), 0};
+    m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for (std::size_t c = 0; c < m_columns.size(); ++c)
+    {
+        // массив столбца дополняется нулями до выравнивания, старое содержимое буфера не пишется
+        std::size_t used = valueSize(m_columns[c].type) * block.rows;
+        std::size_t bytes = columnBytes(m_columns[c].type, block.rows);
+        m_file.write(block.columns[c].data(), used);
+        static const char zeros[kAlign] = {};
+        m_file.write(zeros, bytes - used);
+    }
+    if (!m_file)
+        throw std::runtime_error("Error writing results file");
+}
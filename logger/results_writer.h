@@ -0,0 +1,160 @@
+#pragma once
+#ifndef RESULTS_WRITER_H
+#define RESULTS_WRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "common/common.h"
+
+/**
+ * Формат двоичного файла результатов.
+ *
+ * @details
+ *      Заголовок:
+ *          char     magic[8]       "SIGRES01"
+ *          uint32_t columnCount
+ *          uint32_t reserved       0
+ *          columnCount описаний по 32 байта: uint32_t type, char name[28] (с завершающим нулём)
+ *      Дальше блоки до конца файла:
+ *          uint32_t rows
+ *          uint32_t reserved       0
+ *          для каждого столбца rows значений своего типа, дополненных нулями до кратного 8 размера
+ *
+ *      Все числа записаны в порядке байтов машины (little-endian на x86). Внутри блока значения
+ *      одного столбца лежат подряд, поэтому читатель может отобразить файл в память и работать
+ *      со столбцами как с массивами, не разбирая строки.
+ */
+namespace results_format
+{
+    constexpr char kMagic[8] = {'S', 'I', 'G', 'R', 'E', 'S', '0', '1'};
+    constexpr std::size_t kNameSize = 28;
+    constexpr std::size_t kAlign = 8;
+
+    enum ColumnType : uint32_t
+    {
+        kUInt32 = 1,
+        kFloat64 = 2
+    };
+
+    // Размер одного значения столбца
+    inline std::size_t valueSize(ColumnType type)
+    {
+        return type == kFloat64 ? sizeof(double) : sizeof(uint32_t);
+    }
+
+    // Размер массива столбца в блоке с учётом выравнивания
+    inline std::size_t columnBytes(ColumnType type, std::size_t rows)
+    {
+        return (valueSize(type) * rows + kAlign - 1) / kAlign * kAlign;
+    }
+
+    struct Column
+    {
+        std::string name;
+        ColumnType type;
+    };
+}
+
+/**
+ * Запись результатов в двоичный столбцовый файл с фоновым сбросом на диск.
+ *
+ * @details
+ *      Строки накапливаются в блоке по столбцам; заполненный блок передаётся фоновому потоку,
+ *      который пишет его одним большим вызовом, а запись строк продолжается в следующий блок.
+ *      В работе не больше kBlocks блоков: если диск не успевает, запись строк ждёт.
+ *
+ *      Строка заполняется вызовами push (по одному значению на столбец, в порядке столбцов)
+ *      и завершается endRow.
+ */
+class ResultsWriter
+{
+public:
+    /**
+     * @param path файл результатов (перезаписывается)
+     * @param columns схема: имена и типы столбцов
+     * @param blockRows число строк в блоке
+     * @param append дописывать блоки в конец существующего файла с той же схемой, не записывая заголовок
+     * @throw std::runtime_error если файл не удаётся открыть
+     */
+    ResultsWriter(const std::string& path, const List<results_format::Column>& columns,
+                  std::size_t blockRows = 1 << 16, bool append = false);
+
+    // Сбрасывает неполный блок и дожидается записи
+    ~ResultsWriter();
+
+    ResultsWriter(const ResultsWriter&) = delete;
+    ResultsWriter& operator=(const ResultsWriter&) = delete;
+
+    // Значение следующего столбца строки; тип должен совпадать со схемой
+    void push(uint32_t value);
+    void push(double value);
+
+    /**
+     * Завершает строку
+     *
+     * @throw std::logic_error если заполнены не все столбцы
+     * @throw ошибку записи фонового потока, если она произошла
+     */
+    void endRow();
+
+    /**
+     * Записывает накопленные строки неполным блоком и дожидается, пока они окажутся в файле
+     *
+     * @throw ошибку записи фонового потока, если она произошла
+     */
+    void flush();
+
+    /**
+     * Записывает все накопленные строки и закрывает файл
+     *
+     * @throw ошибку записи фонового потока, если она произошла
+     */
+    void close();
+
+private:
+    static constexpr std::size_t kBlocks = 4;
+
+    // Блок строк: массивы значений по столбцам
+    struct Block
+    {
+        List<List<char>> columns;
+        std::size_t rows = 0;
+    };
+
+    // Место под значение типа type в текущей строке
+    char* nextValue(results_format::ColumnType type);
+
+    // Отдаёт текущий блок фоновому потоку и берёт свободный
+    void submit();
+
+    // Цикл фонового потока
+    void writerLoop();
+
+    void writeBlock(const Block& block);
+
+    List<results_format::Column> m_columns;
+    std::size_t m_blockRows;
+    std::ofstream m_file;
+
+    Block m_blocks[kBlocks];
+    std::size_t m_current = 0;       // Блок, который заполняется строками
+    std::size_t m_column = 0;        // Следующий столбец текущей строки
+
+    std::mutex m_mutex;              // Защищает поля ниже
+    std::condition_variable m_ready; // Появился блок для записи или пора завершаться
+    std::condition_variable m_freed; // Фоновый поток освободил блок
+    std::size_t m_queued = 0;        // Блоки, ждущие записи (идут по кругу за m_current)
+    bool m_stop = false;
+    bool m_closed = false;
+    std::exception_ptr m_error;
+    std::thread m_thread;
+};
+
+#endif // RESULTS_WRITER_H
@@ -2,34 +2,181 @@
 #include <string>   // Для std::stod
 #include "logger/logger.h"
 #include "monte_carlo/monte_carlo.h"
+#include "stats/scoped_timer.h"
+
+// Печать справки по запуску
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [options] <n> <g> <s> <d0> <d1> ... <dn>" << std::endl;
+    std::cerr << "<n> = vertices number for experiment\n";
+    std::cerr << "<g> = number of graphs to generate for experiment\n";
+    std::cerr << "<s> = number of searches run on each graph\n";
+    std::cerr << "<di> = densities for experiment\n";
+    std::cerr << "options:\n";
+    std::cerr << "--threads=<t> = worker threads for (density, graph) tasks, 0 = all cores (default 1)\n";
+    std::cerr << "--search-threads=<t> = build graphs one at a time and spread each graph's searches over <t> threads, 0 = all cores (default 1)\n";
+    std::cerr << "--seed=<u64> = master seed; equal seeds reproduce the run bit for bit (default: random)\n";
+    std::cerr << "--search=<m1,m2,...> = search methods among bfs, dfs, bibfs, msbfs; log columns keep the order bfs dfs bibfs msbfs (default bfs,dfs)\n";
+    std::cerr << "--results=<file> = write search results to a binary columnar file instead of logger/log.txt\n";
+    std::cerr << "--stats=<file> = keep per-density aggregates (moments, quantile sketches, heatmaps) and write them to <file>\n";
+    std::cerr << "--stats-interval=<sec> = also rewrite the stats file while running, at most every <sec> seconds\n";
+    std::cerr << "--write-snapshots=<dir> = save every generated graph to <dir> as a binary snapshot\n";
+    std::cerr << "--snapshots=<dir> = read graphs from snapshots in <dir> (same n, densities and graph count) instead of generating them\n";
+    std::cerr << "--graph=<auto|csr|matrix> = graph storage; auto takes the bit matrix where it is smaller than CSR (default auto, CSR with snapshots)\n";
+    std::cerr << "--bfs=<topdown|hybrid> = bfs engine; hybrid switches between top-down and bottom-up steps, same results (default topdown)\n";
+    std::cerr << "--bfs-alpha=<a> --bfs-beta=<b> = hybrid bfs goes bottom-up when frontier > unvisited / a and back when frontier < n / b (default 0.25, 24)\n";
+    std::cerr << "--order-cache=<k> = answer bfs/dfs searches of a source that starts at least <k> searches from one full traversal, same results; 0 = off (default 4)\n";
+    std::cerr << "--density-ladder = build each graph once per seed and grow it through the densities in increasing order (nested graphs, common random numbers); the log goes graph by graph\n";
+    std::cerr << "--profile=<file> = write per-phase timings and counters per thread and density (CSV, JSON if *.json)\n";
+    std::cerr << "--log=off = do not write per-search results (log.txt or --results file)\n";
+    std::cerr << "--checkpoint[=<sec>] = save progress to <output>.checkpoint (logger/log.txt or the --results file) at most every <sec> seconds and at the end (default 300)\n";
+    std::cerr << "--resume = continue from the checkpoint of an interrupted run with the same arguments: skip finished work and append to its output; the seed is taken from the checkpoint unless given\n";
+    std::cerr << "--all-pairs = write the distance distribution over all vertex pairs of every graph to logger/dist.txt\n";
+}
+
+// Разбор списка методов поиска вида "bfs,bibfs"; false, если встретился неизвестный метод
+bool parseSearches(const std::string& value, List<SearchKind>& searches)
+{
+    searches.clear();
+    std::size_t begin = 0;
+    while (begin <= value.size())
+    {
+        std::size_t end = value.find(',', begin);
+        if (end == std::string::npos)
+            end = value.size();
+        std::string name = value.substr(begin, end - begin);
+        if (name == "bfs")
+            searches.push_back(kBfs);
+        else if (name == "dfs")
+            searches.push_back(kDfs);
+        else if (name == "bibfs")
+            searches.push_back(kBiBfs);
+        else if (name == "msbfs")
+            searches.push_back(kMsBfs);
+        else
+            return false;
+        begin = end + 1;
+    }
+    return !searches.empty();
+}
 
 int main(int argc, char *argv[])
 {
-	if (argc < 5)
+    // Аргументы вида --name=value считаем настройками, остальные -- позиционными параметрами
+    Map<std::string, std::string> options;
+    List<std::string> args;
+    for (int i = 1; i < argc; ++i)
     {
-        std::cerr << "Usage: " << argv[0] << " <n> <g> <s> <d0> <d1> ... <dn>" << std::endl;
-        std::cerr << "<n> = vertices number for experiment\n";
-        std::cerr << "<g> = number of graphs to generate for experiment\n";
-        std::cerr << "<s> = number of searches run on each graph\n";
-        std::cerr << "<di> = densities for experiment\n";
-        return 1;
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) == 0)
+        {
+            auto eq = arg.find('=');
+            options[arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2)] =
+                eq == std::string::npos ? "" : arg.substr(eq + 1);
+        }
+        else
+            args.push_back(arg);
     }
 
+	if (args.size() < 4)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
 
-    int n = std::atoi(argv[1]);          // Получаем количество вершин из аргументов командной строки
-    int graphs = std::atoi(argv[2]);     // Количество графов для каждой плотности
-    int searches = std::atoi(argv[3]);   // Количество запусков для каждого графа
+    int n = std::stoi(args[0]);          // Получаем количество вершин из аргументов командной строки
+    int graphs = std::stoi(args[1]);     // Количество графов для каждой плотности
+    int searches = std::stoi(args[2]);   // Количество запусков для каждого графа
 
     List<double> densities;
-    for (unsigned i = 4; i < argc; ++i)
+    for (std::size_t i = 3; i < args.size(); ++i)
     {
-        std::cout << "Density: " << std::stod(argv[i]) << std::endl;
-        densities.push_back(std::stod(argv[i])); // Получаем значение плотности из аргументов командной строки
+        std::cout << "Density: " << std::stod(args[i]) << std::endl;
+        densities.push_back(std::stod(args[i])); // Получаем значение плотности из аргументов командной строки
     }
-	Logger log("logger/log.txt", "logger/err.txt");
-    MonteCarlo mc(densities, n, graphs, searches, log);
+
+    MonteCarloOptions mcOptions;
+    mcOptions.seed = Randomizer::randomSeed();
+    for (const auto& [name, value] : options)
+    {
+        if (name == "threads")
+            mcOptions.numThreads = std::stoi(value);
+        else if (name == "search-threads")
+            mcOptions.searchThreads = std::stoi(value);
+        else if (name == "seed")
+            mcOptions.seed = std::stoull(value);
+        else if (name == "search" && parseSearches(value, mcOptions.searches))
+            continue;
+        else if (name == "all-pairs")
+            mcOptions.allPairs = true;
+        else if (name == "results" && !value.empty())
+            mcOptions.resultsPath = value;
+        else if (name == "stats" && !value.empty())
+            mcOptions.statsPath = value;
+        else if (name == "stats-interval")
+            mcOptions.statsInterval = std::stod(value);
+        else if (name == "profile" && !value.empty())
+            mcOptions.profilePath = value;
+        else if (name == "snapshots" && !value.empty())
+            mcOptions.snapshotDir = value;
+        else if (name == "write-snapshots" && !value.empty())
+            mcOptions.writeSnapshotDir = value;
+        else if (name == "graph" && (value == "auto" || value == "csr" || value == "matrix"))
+            mcOptions.storage = value == "auto" ? kStorageAuto : value == "csr" ? kStorageCsr : kStorageMatrix;
+        else if (name == "bfs" && (value == "topdown" || value == "hybrid"))
+            mcOptions.hybridBfs = value == "hybrid";
+        else if (name == "bfs-alpha")
+            mcOptions.bfsDirection.alpha = std::stod(value);
+        else if (name == "bfs-beta")
+            mcOptions.bfsDirection.beta = std::stod(value);
+        else if (name == "order-cache")
+            mcOptions.orderCacheMin = std::stoi(value);
+        else if (name == "density-ladder")
+            mcOptions.densityLadder = true;
+        else if (name == "log" && (value == "on" || value == "off"))
+            mcOptions.rawLog = value == "on";
+        else if (name == "checkpoint")
+        {
+            if (!value.empty())
+                mcOptions.checkpointInterval = std::stod(value);
+        }
+        else if (name == "resume" && value.empty())
+            mcOptions.resume = true;
+        else
+        {
+            std::cerr << "Unknown option or value --" << name << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!mcOptions.snapshotDir.empty() && !mcOptions.writeSnapshotDir.empty())
+    {
+        std::cerr << "--snapshots and --write-snapshots are mutually exclusive" << std::endl;
+        return 1;
+    }
+    if (mcOptions.numThreads != 1 && mcOptions.searchThreads != 1)
+    {
+        std::cerr << "--threads and --search-threads are mutually exclusive" << std::endl;
+        return 1;
+    }
+    if (options.count("checkpoint") || mcOptions.resume)
+    {
+        // контрольная точка лежит рядом с выводом
+        mcOptions.checkpointPath = (mcOptions.resultsPath.empty() ? "logger/log.txt" : mcOptions.resultsPath)
+                                   + ".checkpoint";
+        if (mcOptions.resume && !options.count("seed"))
+            mcOptions.seed = Checkpoint::read(mcOptions.checkpointPath).seed;
+    }
+    if (!ENABLE_PROFILE && !mcOptions.profilePath.empty())
+        std::cerr << "--profile ignored: built with ENABLE_PROFILE=0" << std::endl;
+    std::cerr << "seed: " << mcOptions.seed << std::endl;
+
+	Logger log(mcOptions.rawLog && mcOptions.resultsPath.empty() ? "logger/log.txt" : "", "logger/err.txt",
+               mcOptions.allPairs ? "logger/dist.txt" : "", mcOptions.resume);
+    MonteCarlo mc(densities, n, graphs, searches, log, mcOptions);
 
     mc.initialize();
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,262 @@
+/**
+ * Замеры этапов конвейера: генерация и распаковка кода Прюфера, номера пар, построение CSR,
+ * достройка графа до плотности (добавлением рёбер и через дополнение) и обходы.
+ *
+ * Для каждого n из сетки и каждой плотности случаи выполняются warmup раз без замера и reps раз
+ * с замером; входные данные всех повторов одинаковы и задаются затравкой. Результаты пишутся
+ * в JSON и могут сравниваться с сохранённым базовым файлом того же формата.
+ */
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <stack>
+#include <string>
+
+#include "bench/bench.h"
+#include "graph/edge.h"
+#include "graph/traversal.h"
+#include "prufer_graph/prufer.h"
+#include "prufer_graph/random_graph.h"
+
+// Печать справки по запуску
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "options:\n";
+    std::cerr << "--n=<n1,n2,...> = vertex counts (default 1000,4000)\n";
+    std::cerr << "--density=<d1,d2,...> = densities; >= " << MIN_INVERSE_DENSITY
+              << " exercises the inverse graph (default 0.01,0.1,0.6,0.9)\n";
+    std::cerr << "--reps=<r> = measured repetitions per case (default 5)\n";
+    std::cerr << "--warmup=<w> = unmeasured repetitions before measuring (default 1)\n";
+    std::cerr << "--searches=<s> = searches per traversal repetition (default 100)\n";
+    std::cerr << "--seed=<u64> = seed of all inputs (default 1)\n";
+    std::cerr << "--filter=<text> = only cases whose name contains <text>\n";
+    std::cerr << "--out=<file> = write JSON to <file> instead of stdout\n";
+    std::cerr << "--baseline=<file> = compare medians with a previous JSON; exit code 2 on regressions\n";
+    std::cerr << "--threshold=<f> = relative slowdown reported as a regression (default 0.1)\n";
+}
+
+// Разбор списка чисел через запятую
+List<double> parseNumbers(const std::string& value)
+{
+    List<double> numbers;
+    std::size_t begin = 0;
+    while (begin <= value.size())
+    {
+        std::size_t end = value.find(',', begin);
+        if (end == std::string::npos)
+            end = value.size();
+        numbers.push_back(std::stod(value.substr(begin, end - begin)));
+        begin = end + 1;
+    }
+    return numbers;
+}
+
+// Поиски from[i] -> to[i] обходом StorageType; возвращает суммарное число посещённых вершин
+template<class StorageType, class Index>
+uint64_t searchAll(BasicTraverser<Index>& traverser, const List<Index>& from, const List<Index>& to, double density)
+{
+    uint64_t visited = 0;
+    for (std::size_t i = 0; i < from.size(); ++i)
+    {
+        traverser.clear();
+        traverser.template traverse<StorageType>(from[i], to[i], density);
+        visited += traverser.getTraverseOrder().size();
+    }
+    return visited;
+}
+
+// Параметры сетки и отбор случаев
+struct BenchGrid
+{
+    List<double> densities{0.01, 0.1, 0.6, 0.9};
+    int searches = 100;
+    std::string filter;
+};
+
+// Все случаи для графов на n вершинах с номерами типа Index
+template<class Index>
+void benchGraphs(BenchRunner& runner, uint32_t n, const BenchGrid& grid, List<BenchResult>& results)
+{
+    using Edge = BasicEdge<Index>;
+    const uint64_t seed = runner.config().seed;
+    auto noSetup = [] {};
+    auto add = [&](const std::string& name, double density, uint64_t ops, auto&& setup, auto&& body)
+    {
+        if (!grid.filter.empty() && name.find(grid.filter) == std::string::npos)
+            return;
+        results.push_back(runner.run(name, n, density, ops, setup, body));
+        std::cerr << name << " n=" << n << " density=" << density << ": " << results.back().median << " ns/op\n";
+    };
+
+    // Потоки генератора: 0 -- код Прюфера, 1 -- рёбра, 2 -- концы поисков, 3 -- номера пар
+    Randomizer rand(seed, 0);
+    List<int> code;
+    add("prufer_gen", 0, 1, [&] { rand = Randomizer(seed, 0); },
+        [&] { code = prufer_gen(n, rand); return static_cast<uint64_t>(code.back()); });
+    rand = Randomizer(seed, 0);
+    code = prufer_gen(n, rand);
+
+    BasicCsrGraph<Index> graph;
+    add("prufer_unpack", 0, 1, noSetup, [&] { prufer_unpack(code, n, graph); return graph.edgesCount(); });
+    const List<Edge> tree = prufer_unpack<Index>(code, n);
+
+    // Номера пар -> пары, по одному и пачкой
+    List<uint64_t> pairIndices(16 * static_cast<std::size_t>(n));
+    List<Edge> pairs(pairIndices.size());
+    rand = Randomizer(seed, 3);
+    for (uint64_t& index : pairIndices)
+        index = rand.next64() % pair_index::count(n);
+    add("pair_decode", 0, pairIndices.size(), noSetup, [&]
+    {
+        uint64_t sum = 0;
+        for (uint64_t index : pairIndices)
+            sum += pair_index::decode<Index>(n, index).second;
+        return sum;
+    });
+    add("pair_decode_batch", 0, pairIndices.size(), noSetup, [&]
+    {
+        pair_index::decode(n, pairIndices.data(), pairIndices.size(), pairs.data());
+        return static_cast<uint64_t>(pairs.back().second);
+    });
+
+    for (double density : grid.densities)
+    {
+        const bool inverse = density >= MIN_INVERSE_DENSITY;
+        if (!inverse)
+        {
+            // Только разреженные графы: плотные строятся через дополнение
+            List<Edge> edges;
+            add("new_pairs", density, 1, [&] { edges = tree; rand = Randomizer(seed, 1); },
+                [&] { generate_new_pairs_unpacked(n, edges, density, rand); return edges.size(); });
+            add("transform", density, 1, [&]
+            {
+                if (edges.size() > tree.size())
+                    return;
+                edges = tree;
+                rand = Randomizer(seed, 1);
+                generate_new_pairs_unpacked(n, edges, density, rand);
+            }, [&] { return transform(edges, n).edgesCount(); });
+        }
+        add(inverse ? "density_inverse" : "density_add", density, 1,
+            [&] { prufer_unpack(code, n, graph); rand = Randomizer(seed, 1); },
+            [&] { setGraphDensity(graph, density, rand); return graph.edgesCount(); });
+
+        // Граф для обходов строится заново: случай достройки мог быть отфильтрован
+        rand = Randomizer(seed, 1);
+        prufer_unpack(code, n, graph);
+        setGraphDensity(graph, density, rand);
+        List<Index> from(grid.searches);
+        List<Index> to(grid.searches);
+        rand = Randomizer(seed, 2);
+        for (int i = 0; i < grid.searches; ++i)
+        {
+            from[i] = rand.uRand(0, n - 1);
+            do
+                to[i] = rand.uRand(0, n - 1);
+            while (to[i] == from[i]);
+        }
+        BasicTraversalWorkspace<Index> workspace;
+        BasicTraverser<Index> traverser(&graph, &workspace);
+        add(inverse ? "bfs_inverse" : "bfs", density, grid.searches, noSetup,
+            [&] { return searchAll<std::queue<Index>>(traverser, from, to, density); });
+        add(inverse ? "dfs_inverse" : "dfs", density, grid.searches, noSetup,
+            [&] { return searchAll<std::stack<Index>>(traverser, from, to, density); });
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchConfig config;
+    BenchGrid grid;
+    List<double> sizes{1000, 4000};
+    std::string outPath;
+    std::string baselinePath;
+    double threshold = 0.1;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        std::string name = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+        if (name == "n")
+            sizes = parseNumbers(value);
+        else if (name == "density")
+            grid.densities = parseNumbers(value);
+        else if (name == "reps")
+            config.reps = std::stoi(value);
+        else if (name == "warmup")
+            config.warmup = std::stoi(value);
+        else if (name == "searches")
+            grid.searches = std::stoi(value);
+        else if (name == "seed")
+            config.seed = std::stoull(value);
+        else if (name == "filter")
+            grid.filter = value;
+        else if (name == "out")
+            outPath = value;
+        else if (name == "baseline")
+            baselinePath = value;
+        else if (name == "threshold")
+            threshold = std::stod(value);
+        else
+        {
+            std::cerr << "Unknown option --" << name << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (config.reps < 1 || config.warmup < 0 || grid.searches < 1)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        BenchRunner runner(config);
+        List<BenchResult> results;
+        for (double size : sizes)
+        {
+            uint32_t n = static_cast<uint32_t>(size);
+            if (n < 3)
+                throw std::invalid_argument("benchmark graphs need at least 3 vertices");
+            dispatchIndex(n, [&](auto index)
+            {
+                benchGraphs<decltype(index)>(runner, n, grid, results);
+            });
+        }
+        std::cerr << "checksum: " << runner.sink() << "\n";
+
+        if (outPath.empty())
+            writeResults(std::cout, config, results);
+        else
+        {
+            std::ofstream out(outPath);
+            if (!out)
+                throw std::runtime_error("Error opening file " + outPath);
+            writeResults(out, config, results);
+        }
+
+        if (!baselinePath.empty())
+        {
+            std::size_t regressions = compareResults(results, readResults(baselinePath), threshold, std::cerr);
+            if (regressions > 0)
+            {
+                std::cerr << regressions << " regression(s) over " << threshold * 100 << "%\n";
+                return 2;
+            }
+        }
+    }
+    catch (std::exception& exc)
+    {
+        std::cerr << exc.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,9 +1,8 @@
 /**
  * Ускоренная версия файла prufer.cpp (за счет отсутсвия записи в файл)
- * Метрики:
- * 1k вершин: 0.037
- * 10k вершин: 2.16
- * 100k вершин: 25
+ * Метрики (1000 запусков в один поток; степени считаются без построения графа):
+ * 10k вершин: 0.16 (только дерево), 4.6 (плотность 0.001)
+ * 100k вершин: 1.3 (только дерево), 46 (плотность 0.0001)
  */
 //#pragma onces
 #include <iostream>
@@ -13,10 +12,8 @@
 #include "prufer_graph/random_graph.h"
 #include "common/service.h"
 
-#include "graph/tree.h"
-#include "graph/edge.h"
-#include "graph/traversal.h"
-#include "graph/node.h"
+#include "prufer_graph/hist.h"
+#include "parallel/work_stealing_pool.h"
 
 /**
  * @brief Главная функция, запускающая алгоритм
@@ -25,47 +22,61 @@
  * @param argv Аргументы командной строки:
  *             1. n - количество вершин в графе
  *             2. density - плотность графа (от 0 до 1)
+ *             3. trials - количество построенных деревьев
+ *             4. seed - (опционально) затравка генератора; одинаковая затравка даёт одинаковую гистограмму
+ *             5. threads - (опционально) число потоков, 0 -- по числу ядер; на гистограмму не влияет
  * 
  * @return 0 - успех, 1 - ошибка
  * 
  * @details
  * 1. Получает из аргументов командной строки количество вершин n и плотность density
  * 2. Генерирует последовательность Прюфера длины n - 2 (дерево на n вершинах)
- * 3. Генерирует случайный граф вершинами и плотностью density на основе остовного дерева
- * 4. Записывает граф в файл graph.dot
- * 5. (опционально) Строит гистограмму степеней вершин
- * 6. (опционально) Записывает гистограмму в файл histogram.bin
+ * 3. Считает степени случайного графа плотности density на основе остовного дерева (sample_degrees),
+ *    не строя списков смежности
+ * 4. Строит гистограмму степеней вершин по всем запускам
+ * 5. Записывает гистограмму в файл histogram2.bin
  */
 int main(int argc, char *argv[])
 {
-    if (argc != 4)
+    if (argc < 4 || argc > 6)
     {
-        std::cerr << "Usage: " << argv[0] << " <n>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <n> <density> <trials> [seed] [threads]" << std::endl;
         return 1;
     }
     int n = std::atoi(argv[1]);          // Получаем значение N из аргументов командной строки
     double density = std::atof(argv[2]); // Получаем значение плотности из аргументов командной строки
     int trials = std::atoi(argv[3]);     // Количество запусков
+    uint64_t seed = argc >= 5 ? std::stoull(argv[4]) : Randomizer::randomSeed();
+    unsigned threads = argc == 6 ? std::stoul(argv[5]) : 0; // 0 -- по числу ядер
     // основной алгоритм построения дерева
     //List<int> prufer_sequence = prufer_gen(n);
-    List<EdgeType> edges = prufer_unpack(prufer_gen(n), n);
        
     //int trials = 1000;
     
     std::vector<int> hist(n, 0); 
-    List<Node> graph;
 
-    for (int i = 0; i < trials; i++)
+    // тип номера вершины выбирается по n: большие графы считаются с 32-битными номерами
+    dispatchIndex(n, [&](auto index)
     {
-        edges = prufer_unpack(prufer_gen(n), n);
-        //generate_new_pairs_unpacked(n, edges, density);
-        graph = transform(edges, n);
-        //graph = get_tree(n);
-        for (auto &edges : graph)
+        using Index = decltype(index);
+        // Запуски независимы: у каждого свой поток случайных чисел, у каждого потока выполнения --
+        // своя гистограмма, поэтому результат не зависит от числа потоков
+        WorkStealingPool pool(threads);
+        List<List<int>> hists(pool.size(), List<int>(n, 0));
+        List<List<Index>> degrees(pool.size());
+        List<List<BasicEdge<Index>>> edges(pool.size());
+        pool.run(trials, [&](std::size_t trial, unsigned worker)
         {
-            ++hist.at(edges.incident.size());
-        }
-    }
+            Randomizer rand(seed, trial); // у каждого запуска свой поток случайных чисел
+            // списки смежности не строятся: степени берутся из кода Прюфера и выборки рёбер
+            sample_degrees(prufer_gen(n, rand), n, density, rand, degrees[worker], edges[worker]);
+            for (Index deg : degrees[worker])
+                ++hists[worker].at(deg);
+        });
+        for (const auto& part : hists)
+            for (int deg = 0; deg < n; ++deg)
+                hist[deg] += part[deg];
+    });
     //std::string filename = "graph.dot";
     //write_dot_file(edges, filename);
 
@@ -0,0 +1,151 @@
+/**
+ * Чтение двоичного файла результатов (main --results=<file>)
+ *
+ * Режимы:
+ *   text    -- все столбцы текстом, первая строка -- схема
+ *   log     -- строки в формате logger/log.txt: n density dist <методы поиска>
+ *   summary -- по каждой плотности: число поисков, среднее и максимум каждого столбца-счётчика
+ */
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include "logger/results_reader.h"
+
+// Печать справки по запуску
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " <file> [text|log|summary]" << std::endl;
+}
+
+// Значение столбца column строки row как текст
+void printValue(std::ostream& out, const ResultsReader& reader, const ResultsReader::Block& block,
+                std::size_t column, std::size_t row)
+{
+    if (reader.columns()[column].type == results_format::kFloat64)
+        out << block.float64At(column, row);
+    else
+        out << block.uint32At(column, row);
+}
+
+// Вывод файла path в режиме mode; false, если режим неизвестен или файл не подходит
+bool convert(const std::string& path, const std::string& mode)
+{
+    ResultsReader reader(path);
+    const auto& columns = reader.columns();
+    std::ios::sync_with_stdio(false);
+
+    if (mode == "text" || mode == "log")
+    {
+        // в формате лога пропускаем номера графа и поиска
+        List<std::size_t> selected;
+        for (std::size_t c = 0; c < columns.size(); ++c)
+            if (mode == "text" || (columns[c].name != "graph" && columns[c].name != "search"))
+                selected.push_back(c);
+
+        if (mode == "text")
+        {
+            std::cout << '#';
+            for (std::size_t c : selected)
+                std::cout << ' ' << columns[c].name;
+            std::cout << '\n';
+        }
+        reader.forEachBlock([&](const ResultsReader::Block& block)
+        {
+            for (std::size_t row = 0; row < block.rows; ++row)
+            {
+                for (std::size_t i = 0; i < selected.size(); ++i)
+                {
+                    if (i > 0)
+                        std::cout << ' ';
+                    printValue(std::cout, reader, block, selected[i], row);
+                }
+                std::cout << '\n';
+            }
+        });
+        return true;
+    }
+
+    if (mode != "summary")
+    {
+        std::cerr << "unknown mode " << mode << std::endl;
+        return false;
+    }
+
+    // Итоги по плотностям в порядке их появления в файле
+    std::size_t densityColumn = reader.findColumn("density");
+    if (densityColumn == columns.size())
+    {
+        std::cerr << "no density column" << std::endl;
+        return false;
+    }
+    List<std::size_t> counters;
+    for (std::size_t c = 0; c < columns.size(); ++c)
+        if (columns[c].type == results_format::kUInt32 && columns[c].name != "n" && columns[c].name != "graph"
+            && columns[c].name != "search")
+            counters.push_back(c);
+
+    struct Totals
+    {
+        std::size_t searches = 0;
+        List<double> sum;
+        List<uint32_t> max;
+    };
+    List<double> densities;
+    Map<double, Totals> totals;
+    reader.forEachBlock([&](const ResultsReader::Block& block)
+    {
+        for (std::size_t row = 0; row < block.rows; ++row)
+        {
+            double density = block.float64At(densityColumn, row);
+            auto [it, inserted] = totals.try_emplace(density);
+            Totals& entry = it->second;
+            if (inserted)
+            {
+                densities.push_back(density);
+                entry.sum.assign(counters.size(), 0);
+                entry.max.assign(counters.size(), 0);
+            }
+            ++entry.searches;
+            for (std::size_t i = 0; i < counters.size(); ++i)
+            {
+                uint32_t value = block.uint32At(counters[i], row);
+                entry.sum[i] += value;
+                entry.max[i] = std::max(entry.max[i], value);
+            }
+        }
+    });
+
+    std::cout << "density searches";
+    for (std::size_t c : counters)
+        std::cout << " mean_" << columns[c].name << " max_" << columns[c].name;
+    std::cout << '\n';
+    for (double density : densities)
+    {
+        const Totals& entry = totals[density];
+        std::cout << density << ' ' << entry.searches;
+        for (std::size_t i = 0; i < counters.size(); ++i)
+            std::cout << ' ' << entry.sum[i] / entry.searches << ' ' << entry.max[i];
+        std::cout << '\n';
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2 && argc != 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string mode = argc == 3 ? argv[2] : "text";
+    try
+    {
+        return convert(argv[1], mode) ? 0 : 1;
+    }
+    catch (std::exception& exc)
+    {
+        std::cerr << exc.what() << std::endl;
+        return 1;
+    }
+}
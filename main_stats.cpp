@@ -0,0 +1,105 @@
+/**
+ * Работа с файлами сводок (main --stats=<file>)
+ *
+ * Режимы:
+ *   summary <file>...        -- слить сводки и вывести по каждой плотности среднее, стандартное
+ *                               отклонение и квантили расстояния и посещённых вершин
+ *   merge <out> <file>...    -- слить сводки (например, запусков на разных машинах) в один файл
+ */
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "stats/search_stats.h"
+
+// Печать справки по запуску
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " summary <file>..." << std::endl;
+    std::cerr << "       " << program << " merge <out> <file>..." << std::endl;
+}
+
+// Сливает сводки из файлов по плотностям (в порядке первого появления плотности)
+void mergeFiles(const List<std::string>& paths, List<double>& densities, List<SearchStats>& merged)
+{
+    for (const auto& path : paths)
+    {
+        std::ifstream in(path);
+        if (!in)
+            throw std::runtime_error("Error opening file " + path);
+        double density;
+        SearchStats stats;
+        while (SearchStats::read(in, density, stats))
+        {
+            std::size_t i = 0;
+            while (i < densities.size() && densities[i] != density)
+                ++i;
+            if (i == densities.size())
+            {
+                densities.push_back(density);
+                merged.push_back(stats);
+            }
+            else
+                merged[i].merge(stats);
+        }
+    }
+}
+
+void printSummary(const List<double>& densities, const List<SearchStats>& merged)
+{
+    std::cout << "density column searches mean sd p50 p90 p99 max\n";
+    for (std::size_t i = 0; i < densities.size(); ++i)
+    {
+        const SearchStats& stats = merged[i];
+        for (std::size_t c = 0; c <= stats.methods().size(); ++c)
+        {
+            const RunningStats& moments = stats.moments(c);
+            const QuantileSketch& sketch = stats.sketch(c);
+            std::cout << densities[i] << ' ' << stats.columnName(c) << ' ' << moments.count << ' ' << moments.mean
+                      << ' ' << std::sqrt(moments.variance()) << ' ' << sketch.quantile(0.5) << ' '
+                      << sketch.quantile(0.9) << ' ' << sketch.quantile(0.99) << ' '
+                      << (moments.count ? moments.max : 0) << '\n';
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string mode = argv[1];
+    bool merge = mode == "merge";
+    if ((mode != "summary" && !merge) || (merge && argc < 4))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        List<std::string> paths(argv + (merge ? 3 : 2), argv + argc);
+        List<double> densities;
+        List<SearchStats> merged;
+        mergeFiles(paths, densities, merged);
+        if (!merge)
+        {
+            printSummary(densities, merged);
+            return 0;
+        }
+        std::ofstream out(argv[2]);
+        if (!out)
+            throw std::runtime_error(std::string("Error opening file ") + argv[2]);
+        for (std::size_t i = 0; i < densities.size(); ++i)
+            merged[i].write(out, densities[i]);
+    }
+    catch (std::exception& exc)
+    {
+        std::cerr << exc.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "checkpoint.h"
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+void Checkpoint::write(const std::string& path) const
+{
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath);
+        if (!out)
+            throw std::runtime_error("Error opening file " + tmpPath);
+        out.precision(std::numeric_limits<double>::max_digits10);
+        out << "checkpoint 1\n";
+        out << "seed " << seed << '\n';
+        out << "grid " << numVertices << ' ' << numGraphs << ' ' << numSearches << ' ' << densities.size();
+        for (double density : densities)
+            out << ' ' << density;
+        out << '\n';
+        out << "setup " << setup << '\n';
+        out << "tasks " << tasks << '\n';
+        out << "files " << logSizes.log << ' ' << logSizes.dist << ' ' << resultsBytes << '\n';
+        out << "stats " << stats.size() << '\n';
+        for (std::size_t i = 0; i < stats.size(); ++i)
+            stats[i].write(out, densities[i]);
+        if (!out)
+            throw std::runtime_error("Error writing file " + tmpPath);
+    }
+    std::filesystem::rename(tmpPath, path);
+}
+
+Checkpoint Checkpoint::read(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Checkpoint not found: " + path);
+
+    Checkpoint checkpoint;
+    int version;
+    expectWord(in, "checkpoint", "checkpoint");
+    in >> version;
+    if (!in || version != 1)
+        throw std::runtime_error("unsupported checkpoint version");
+    expectWord(in, "seed", "checkpoint");
+    in >> checkpoint.seed;
+    expectWord(in, "grid", "checkpoint");
+    std::size_t count;
+    in >> checkpoint.numVertices >> checkpoint.numGraphs >> checkpoint.numSearches >> count;
+    checkpoint.densities.resize(count);
+    for (double& density : checkpoint.densities)
+        in >> density;
+    expectWord(in, "setup", "checkpoint");
+    in >> checkpoint.setup;
+    expectWord(in, "tasks", "checkpoint");
+    in >> checkpoint.tasks;
+    expectWord(in, "files", "checkpoint");
+    in >> checkpoint.logSizes.log >> checkpoint.logSizes.dist >> checkpoint.resultsBytes;
+    expectWord(in, "stats", "checkpoint");
+    in >> count;
+    if (!in)
+        throw std::runtime_error("malformed checkpoint header");
+    checkpoint.stats.resize(count);
+    for (auto& stats : checkpoint.stats)
+    {
+        double density;
+        if (!SearchStats::read(in, density, stats))
+            throw std::runtime_error("malformed checkpoint: stats are truncated");
+    }
+    return checkpoint;
+}
+
+bool Checkpoint::sameRun(const Checkpoint& other) const
+{
+    return seed == other.seed && numVertices == other.numVertices && numGraphs == other.numGraphs
+        && numSearches == other.numSearches && densities == other.densities && setup == other.setup;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+
+#include "common/common.h"
+#include "logger/logger.h"
+#include "stats/search_stats.h"
+
+/**
+ * Контрольная точка эксперимента: сколько задач уже записано и где кончается их вывод.
+ *
+ * @details
+ *      Задачи записываются строго по порядку номеров, поэтому выполненная работа -- это префикс
+ *      из tasks задач. Положения случайных потоков хранить не нужно: генератор каждой задачи
+ *      выводится из затравки и координат (плотность, граф, назначение), так что продолжение с
+ *      задачи tasks даёт тот же вывод, что и запуск без остановки.
+ *
+ *      Текстовый формат:
+ *          checkpoint 1
+ *          seed <затравка>
+ *          grid <n> <графов> <поисков> <плотностей k> <d_1> ... <d_k>
+ *          setup <настройки, от которых зависит вывод>
+ *          tasks <записано задач>
+ *          files <байт лога> <байт распределений> <байт файла результатов>
+ *          stats <число сводок>
+ *          сводки SearchStats в их собственном формате
+ */
+struct Checkpoint
+{
+    uint64_t seed = 0;
+    uint32_t numVertices = 0;
+    int numGraphs = 0;
+    int numSearches = 0;
+    List<double> densities;
+    std::string setup;            // Одно слово без пробелов
+    uint64_t tasks = 0;
+    Logger::Sizes logSizes;       // Размеры текстовых логов после записанных задач
+    uint64_t resultsBytes = 0;    // Размер двоичного файла результатов (0 -- не пишется)
+    List<SearchStats> stats;      // Сводки по плотностям (пусто -- сводки выключены)
+
+    /**
+     * Записывает контрольную точку: сначала во временный файл, затем переименованием,
+     * так что в path всегда лежит последняя целая точка
+     *
+     * @throw std::runtime_error при ошибке записи
+     */
+    void write(const std::string& path) const;
+
+    /**
+     * Читает контрольную точку
+     *
+     * @throw std::runtime_error если файла нет или формат нарушен
+     */
+    static Checkpoint read(const std::string& path);
+
+    // Та же сетка, затравка и настройки вывода: с этой точки можно продолжить запуск other
+    bool sameRun(const Checkpoint& other) const;
+};
+
+#endif // CHECKPOINT_H
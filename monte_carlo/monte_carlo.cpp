@@ -1,17 +1,31 @@
 #include "monte_carlo.h"
-#include "graph/edge.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+
+#include "parallel/work_stealing_pool.h"
 #include "prufer_graph/prufer.h"
 #include "prufer_graph/random_graph.h"
+#include "stats/scoped_timer.h"
 
-MonteCarlo::MonteCarlo(const List<double>& densities, int numVertices, int numGraphs, int numSearches, Logger& log)
+MonteCarlo::MonteCarlo(const List<double>& densities, int numVertices, int numGraphs, int numSearches, Logger& log,
+                       const MonteCarloOptions& options)
     : m_densities(densities), m_numVertices(numVertices), m_numGraphs(numGraphs),
-    m_numSearches(numSearches), m_logger(log)
-{}
+    m_numSearches(numSearches), m_options(options), m_logger(log)
+{
+    for (SearchKind kind : m_options.searches)
+        m_enabled[kind] = true;
+}
 
 void MonteCarlo::clear() {
-    m_graph.clear();
+    m_pending.clear();
     m_bfsResults.clear();
     m_dfsResults.clear();
+    m_bibfsResults.clear();
+    m_msbfsResults.clear();
     m_dist.clear();
 }
 
@@ -23,109 +37,818 @@ const List<int>& MonteCarlo::getDFSResults() const {
     return m_dfsResults;
 }
 
+const List<int>& MonteCarlo::getBiBFSResults() const {
+    return m_bibfsResults;
+}
+
+const List<int>& MonteCarlo::getMsBFSResults() const {
+    return m_msbfsResults;
+}
+
 // Инициализация алгоритма
 void MonteCarlo::initialize() {
-    using Clock = std::chrono::steady_clock;
     std::cerr << "starting pocess\n\n";
-    Clock::time_point begin = Clock::now();
-    Clock::time_point iter = begin;
-    Clock::time_point persearch = begin;
-    float avg = 0;
-    //Clock::time_point end = iter;
-
-    for (double curDensity : m_densities)
-    {
-        std::cerr << "density: " << curDensity << "\n";
-        iter = Clock::now();        
-        avg = 0;
-        for (int graphIndex = 0; graphIndex < m_numGraphs; ++graphIndex) 
-        {
-            
-            // TODO разделить методы: надо получать не только эти данные
-            try
-            {
-                m_graph = buildGraph(m_numVertices, curDensity);
-            }
-            catch (std::exception& exc)
+    m_begin = Clock::now();
+    m_iter = m_begin;
+    m_avg = 0;
+    m_nextCommit = 0;
+    m_firstTask = 0;
+    m_checkpointWritten = m_begin;
+    m_stats.clear();
+    if (!m_options.statsPath.empty())
+    {
+        m_stats.assign(m_densities.size(), SearchStats(enabledMethods(), m_numVertices));
+        m_statsWritten = m_begin;
+    }
+    if (m_options.resume)
+        resume();
+    if (m_options.rawLog && !m_options.resultsPath.empty())
+        m_results = std::make_unique<ResultsWriter>(m_options.resultsPath, resultColumns(), 1 << 16, m_options.resume);
+    if (!m_options.snapshotDir.empty() && !std::filesystem::is_directory(m_options.snapshotDir))
+        throw std::runtime_error("Snapshot directory not found: " + m_options.snapshotDir);
+    if (!m_options.writeSnapshotDir.empty())
+        std::filesystem::create_directories(m_options.writeSnapshotDir);
+    m_ladder.clear();
+    if (m_options.densityLadder)
+    {
+        for (std::size_t i = 0; i < m_densities.size(); ++i)
+            m_ladder.push_back(i);
+        std::stable_sort(m_ladder.begin(), m_ladder.end(),
+                         [this](std::size_t a, std::size_t b) { return m_densities[a] < m_densities[b]; });
+    }
+
+    // Тип номера вершины выбирается по размеру графа: до 65535 вершин смежность вдвое компактнее
+    dispatchIndex(m_numVertices, [this](auto index)
+    {
+        using Index = decltype(index);
+        chooseStorage<Index>();
+        if (m_options.searchThreads != 1)
+        {
+            // Графы строятся по одному, поиски каждого графа делят пул
+            m_searchPool = std::make_unique<WorkStealingPool>(m_options.searchThreads);
+            std::cerr << "search threads: " << m_searchPool->size() << "\n";
+            runSequential<Index>();
+            m_searchPool.reset();
+        }
+        else if (m_options.numThreads != 1)
+            runParallel<Index>();
+        else
+            runSequential<Index>();
+    });
+    if (m_results)
+        m_results->close();
+    if (!m_stats.empty())
+        writeStats();
+    if (!m_profiles.empty())
+        writeProfile();
+}
+
+template<class Index>
+void MonteCarlo::runSequential() {
+    GraphContext<Index> context;
+    TaskResult result;
+    std::size_t tasks = m_densities.size() * m_numGraphs;
+    startProfile(m_searchPool ? m_searchPool->size() : 1);
+    for (std::size_t task = m_firstTask; task < tasks; ++task)
+    {
+        runTask(context, task, result, 0);
+        commitTask(task, result, 0);
+    }
+}
+
+template<class Index>
+void MonteCarlo::runParallel() {
+    WorkStealingPool pool(m_options.numThreads);
+    std::cerr << "threads: " << pool.size() << "\n";
+
+    std::size_t tasks = m_densities.size() * m_numGraphs;
+    List<GraphContext<Index>> contexts(pool.size());   // Буферы каждого потока
+    m_pending.assign(tasks, TaskResult());
+    startProfile(pool.size());
+
+    // в лестнице плотностей граф каждой плотности строится из предыдущего, поэтому все плотности
+    // графа выполняет один поток, по порядку
+    const std::size_t unitTasks = m_options.densityLadder ? m_densities.size() : 1;
+    const std::size_t firstUnit = m_firstTask / unitTasks;   //< контрольные точки -- только на границах единиц
+    pool.run(tasks / unitTasks - firstUnit, [this, tasks, unitTasks, firstUnit, &contexts](std::size_t unit,
+                                                                                          unsigned worker)
+    {
+        unit += firstUnit;
+        for (std::size_t task = unit * unitTasks; task < (unit + 1) * unitTasks; ++task)
+        {
+            runTask(contexts[worker], task, m_pending[task], worker);
+
+            // Результаты пишутся в лог в порядке номеров задач, как при последовательном запуске:
+            // задача, завершившаяся раньше предшественников, ждёт в m_pending
+            std::lock_guard<std::mutex> lock(m_logMutex);
+            m_pending[task].ready = true;
+            while (m_nextCommit < tasks && m_pending[m_nextCommit].ready)
             {
-                m_logger.errBuild(exc.what(), m_numVertices, curDensity);
-            }
-            
-            persearch = Clock::now();
-            for (int searchIndex = 0; searchIndex < m_numSearches; ++searchIndex) {
-                // Выполняем поиск пути и обновляем результаты
-                searchPath(curDensity);
-                
-                // Логируем результаты после каждого поиска
-                logResults(graphIndex, curDensity, searchIndex);
-            }
-            avg += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - persearch).count();
-            if ((graphIndex + 1) % 100 == 0) {
-                std::cerr << graphIndex + 1 << " graphs processed\n";
-                std::cerr << "Avg search time per " << m_numSearches << "searches = " << avg / (100) << "[mcs] = " << avg / (100) / 1'000'000.0 << " sec" << '\n';
-                std::cerr << "dt from start = " << std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count() << "[mcs] = "
-                            << std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count() / 1'000'000.0 << " sec" << '\n';
-                std::cerr << "dt from last graph iteration = " << std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - iter).count() << "[mcs] = "
-                            << std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - iter).count() / 1'000'000.0 << " sec" << '\n';
-                iter = Clock::now();
-                avg = 0;
+                commitTask(m_nextCommit, m_pending[m_nextCommit], worker);
+                List<SearchResult>().swap(m_pending[m_nextCommit].searches);
+                List<uint64_t>().swap(m_pending[m_nextCommit].distances);
+                ++m_nextCommit;
             }
-            clear();
         }
+    });
+    m_pending.clear();
+}
+
+Randomizer MonteCarlo::makeRandomizer(std::size_t densityIndex, int graphIndex, uint64_t purpose) const {
+    uint64_t density = m_options.densityLadder ? kLadderStreams : densityIndex;
+    return Randomizer(m_options.seed, Randomizer::streamId(density, graphIndex, purpose));
+}
+
+std::size_t MonteCarlo::densityOf(std::size_t task) const {
+    return m_options.densityLadder ? m_ladder[task % m_densities.size()] : task / m_numGraphs;
+}
+
+int MonteCarlo::graphOf(std::size_t task) const {
+    return m_options.densityLadder ? task / m_densities.size() : task % m_numGraphs;
+}
+
+template<class Index>
+void MonteCarlo::runTask(GraphContext<Index>& ctx, std::size_t task, TaskResult& result, unsigned worker) {
+    std::size_t densityIndex = densityOf(task);
+    int graphIndex = graphOf(task);
+    double curDensity = m_densities[densityIndex];
+    result.searches.clear();
+    result.distances.clear();
+    result.searchTime = 0;
+    ctx.profile = profileFor(worker, densityIndex);
+    // с пулом поисков граф строит поток 0, а поток поиска s пишет в свой профиль
+    ctx.searchers.resize(m_searchPool ? m_searchPool->size() : 1);
+    for (std::size_t s = 0; s < ctx.searchers.size(); ++s)
+        ctx.searchers[s].profile = m_searchPool ? profileFor(s, densityIndex) : ctx.profile;
+
+    // TODO разделить методы: надо получать не только эти данные
+    try
+    {
+        buildGraph(ctx, densityIndex, graphIndex);
+    }
+    catch (std::exception& exc)
+    {
+        std::lock_guard<std::mutex> lock(m_logMutex);
+        m_logger.errBuild(exc.what(), m_numVertices, curDensity);
+        return;
+    }
+
+    PROFILE_COUNT(ctx.profile, kCounterGraphs, 1);
+    PROFILE_COUNT(ctx.profile, kCounterEdges, ctx.useMatrix ? ctx.matrix.edgesCount() : ctx.graph.edgesCount());
+
+    Clock::time_point persearch = Clock::now();
+    for (auto& searcher : ctx.searchers)
+    {
+        if (ctx.useMatrix)
+            searcher.batch.setGraph(&ctx.matrix);
+        else
+            searcher.batch.setGraph(&ctx.graph);
+    }
+    if (m_options.allPairs)
+    {
+        PROFILE_SCOPE(ctx.profile, kPhaseAllPairs);
+        result.distances = ctx.searchers[0].batch.distanceDistribution(curDensity);
+    }
+    if (m_enabled[kMsBfs])
+        searchBatches(ctx, densityIndex, graphIndex);
+    searchCached(ctx, densityIndex, graphIndex);
+
+    // Поиски независимы: каждый пишет только в свою ячейку, а в результат они попадают по номерам
+    ctx.searches.resize(m_numSearches);
+    ctx.succeeded.assign(m_numSearches, 0);
+    forEachSearch(m_numSearches, [&](std::size_t searchIndex, unsigned searcher)
+    {
+        // Выполняем поиск пути и запоминаем результаты
+        SearchResult& search = ctx.searches[searchIndex];
+        ctx.succeeded[searchIndex] = searchPath(ctx, ctx.searchers[searcher], densityIndex, graphIndex, searchIndex,
+                                                search);
+        search.index = searchIndex;
+    });
+    for (int searchIndex = 0; searchIndex < m_numSearches; ++searchIndex)
+        if (ctx.succeeded[searchIndex])
+            result.searches.push_back(ctx.searches[searchIndex]);
+    result.searchTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - persearch).count();
+    PROFILE_COUNT(ctx.profile, kCounterSearches, m_numSearches);
+    PROFILE_COUNT(ctx.profile, kCounterFailed, m_numSearches - result.searches.size());
+}
+
+void MonteCarlo::commitTask(std::size_t task, const TaskResult& result, unsigned worker) {
+    std::size_t densityIndex = densityOf(task);
+    int graphIndex = graphOf(task);
+    double curDensity = m_densities[densityIndex];
+    if (m_options.densityLadder ? task == 0 : graphIndex == 0)
+    {
+        if (m_options.densityLadder)
+            std::cerr << "density ladder: " << m_densities.size() << " densities per graph\n";
+        else
+            std::cerr << "density: " << curDensity << "\n";
+        m_iter = Clock::now();
+        m_avg = 0;
+    }
+
+    // Логируем результаты каждого поиска
+    {
+        PROFILE_SCOPE(profileFor(worker, densityIndex), kPhaseLog);
+        if (m_options.rawLog)
+            logResults(task, result);
+        if (!m_stats.empty())
+            aggregate(task, result);
+        if (m_options.allPairs)
+            m_logger.logDistances(m_numVertices, curDensity, result.distances);
+        checkpoint(task);
+    }
+
+    m_avg += result.searchTime;
+    // в лестнице граф готов после своей последней плотности
+    bool graphDone = !m_options.densityLadder || task % m_densities.size() + 1 == m_densities.size();
+    if (graphDone && (graphIndex + 1) % 100 == 0) {
+        std::cerr << graphIndex + 1 << " graphs processed\n";
+        std::cerr << "Avg search time per " << m_numSearches << "searches = " << m_avg / (100) << "[mcs] = " << m_avg / (100) / 1'000'000.0 << " sec" << '\n';
+        std::cerr << "dt from start = " << std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_begin).count() << "[mcs] = "
+                    << std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_begin).count() / 1'000'000.0 << " sec" << '\n';
+        std::cerr << "dt from last graph iteration = " << std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_iter).count() << "[mcs] = "
+                    << std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_iter).count() / 1'000'000.0 << " sec" << '\n';
+        m_iter = Clock::now();
+        m_avg = 0;
+    }
+    if (graphDone && graphIndex + 1 == m_numGraphs)
         std::cerr << "\n";
-    }   
+
+    m_bfsResults.clear();
+    m_dfsResults.clear();
+    m_bibfsResults.clear();
+    m_msbfsResults.clear();
+    m_dist.clear();
+    for (const auto& search : result.searches)
+    {
+        m_bfsResults.push_back(search.bfs);
+        m_dfsResults.push_back(search.dfs);
+        m_bibfsResults.push_back(search.bibfs);
+        m_msbfsResults.push_back(search.msbfs);
+        m_dist.push_back(search.dist);
+    }
 }
 
-List<Node> MonteCarlo::buildGraph(int numEdges, double density) {
+template<class Index>
+void MonteCarlo::buildGraph(GraphContext<Index>& ctx, std::size_t densityIndex, int graphIndex) {
 
     // TODO : переделать на вызов наиболее оптимального метода
     //List<Node> nodes = get_tree(numEdges);
 
-    List<Node> nodes = transform(prufer_unpack(prufer_gen(numEdges), numEdges), numEdges);
-    setGraphDensity(nodes, density);
-    
-    return nodes;
+    ctx.useMatrix = m_useMatrix[densityIndex];
+    if (!m_options.snapshotDir.empty())
+    {
+        PROFILE_SCOPE(ctx.profile, kPhaseSnapshot);
+        loadSnapshot(ctx, densityIndex, graphIndex);
+        return;
+    }
+
+    Randomizer treeRand = makeRandomizer(densityIndex, graphIndex, kTreeStream);
+    Randomizer edgesRand = makeRandomizer(densityIndex, graphIndex, kEdgesStream);
+    // в лестнице плотностей дерево строится один раз на серию, следующие плотности продолжают выборку рёбер
+    if (!m_options.densityLadder || densityIndex == m_ladder.front())
+    {
+        PROFILE_SCOPE(ctx.profile, kPhaseTree);
+        prufer_gen(m_numVertices, treeRand, ctx.build.prufer);
+        prufer_unpack(ctx.build.prufer, m_numVertices, ctx.graph, ctx.build.degree); // дерево пишется сразу в граф
+        if (m_options.densityLadder)
+            ctx.ladder.start(ctx.graph, edgesRand);
+    }
+    {
+        PROFILE_SCOPE(ctx.profile, kPhaseDensify);
+        if (m_options.densityLadder)
+        {
+            ctx.ladder.next(m_densities[densityIndex]);
+            if (ctx.useMatrix)
+                ctx.ladder.build(ctx.matrix);
+            else
+                ctx.ladder.build(ctx.graph);
+        }
+        else if (ctx.useMatrix)
+            setGraphDensity(ctx.matrix, ctx.graph, m_densities[densityIndex], edgesRand, ctx.build);
+        else
+            setGraphDensity(ctx.graph, m_densities[densityIndex], edgesRand, ctx.build);
+    }
+
+    if (!m_options.writeSnapshotDir.empty())
+    {
+        PROFILE_SCOPE(ctx.profile, kPhaseSnapshot);
+        SnapshotInfo info;
+        info.seed = m_options.seed;
+        info.density = m_densities[densityIndex];
+        info.densityIndex = densityIndex;
+        info.graphIndex = graphIndex;
+        info.inverse = info.density >= MIN_INVERSE_DENSITY;
+        std::filesystem::path dir(m_options.writeSnapshotDir);
+        GraphSnapshot::write((dir / GraphSnapshot::fileName(densityIndex, graphIndex)).string(), ctx.graph, info);
+    }
 }
 
-// Поиск пути на графе (в текущем графе)
-void MonteCarlo::searchPath(double curDensity) {
+template<class Index>
+void MonteCarlo::chooseStorage() {
+    // снимки хранят CSR: при их чтении или записи графы строятся в CSR
+    bool snapshots = !m_options.snapshotDir.empty() || !m_options.writeSnapshotDir.empty();
+    m_useMatrix.assign(m_densities.size(), m_options.storage == kStorageMatrix && !snapshots);
+    if (m_options.storage != kStorageAuto || snapshots)
+        return;
 
-    Randomizer rand;
-    Traverser traverser(&m_graph);
-    
-    SizeType from = rand.uRand(0, m_graph.size() - 1);
-    SizeType to = from;
+    // Сравниваются итоговые размеры: CSR хранит смещения и по два номера на ребро (для высоких
+    // плотностей -- на удалённое), матрица -- n строк, выровненных на 64 байта
+    const uint64_t n = m_numVertices;
+    const uint64_t maxEdges = n * (n - 1) / 2;
+    const uint64_t matrixBytes = BasicBitMatrixGraph<Index>::matrixBytes(n);
+    for (std::size_t i = 0; i < m_densities.size(); ++i)
+    {
+        double density = m_densities[i];
+        uint64_t stored = std::round(maxEdges * (density >= MIN_INVERSE_DENSITY ? 1 - density : density));
+        stored = std::max<uint64_t>(stored, n - 1); //< не меньше остовного дерева
+        uint64_t csrBytes = (n + 1) * sizeof(OffsetType) + 2 * stored * sizeof(Index);
+        m_useMatrix[i] = matrixBytes < csrBytes;
+    }
+}
 
-    while (to == from)
-        to = rand.uRand(0, m_graph.size() - 1);
+template<class Index>
+void MonteCarlo::logErrGraph(const GraphContext<Index>& ctx) {
+    if (ctx.useMatrix)
+        m_logger.logErrGraph(ctx.matrix);
+    else
+        m_logger.logErrGraph(ctx.graph);
+}
 
-    try
+template<class Index>
+void MonteCarlo::loadSnapshot(GraphContext<Index>& ctx, std::size_t densityIndex, int graphIndex) {
+    // граф отвязывается от прошлого снимка до того, как тот будет закрыт
+    ctx.graph.clear();
+    ctx.snapshot.reset();
+
+    std::filesystem::path dir(m_options.snapshotDir);
+    std::string path = (dir / GraphSnapshot::fileName(densityIndex, graphIndex)).string();
+    auto snapshot = std::make_unique<GraphSnapshot>(path);
+    const SnapshotInfo& info = snapshot->info();
+    if (info.numVertices != static_cast<uint64_t>(m_numVertices) || info.density != m_densities[densityIndex])
+        throw std::runtime_error("Snapshot " + path + " holds a graph with n = " + std::to_string(info.numVertices)
+                                 + ", density = " + std::to_string(info.density));
+    snapshot->attach(ctx.graph);
+    ctx.snapshot = std::move(snapshot);
+}
+
+// Поиск пути на графе (в текущем графе потока)
+template<class Index>
+BasicTraverser<Index> MonteCarlo::makeTraverser(const GraphContext<Index>& ctx, SearchContext<Index>& searcher) const {
+    return ctx.useMatrix ? BasicTraverser<Index>(&ctx.matrix, &searcher.workspace)
+                         : BasicTraverser<Index>(&ctx.graph, &searcher.workspace);
+}
+
+template<class Run>
+void MonteCarlo::forEachSearch(std::size_t count, Run&& run) {
+    if (!m_searchPool)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            run(i, 0u);
+        return;
+    }
+    m_searchPool->run(count, [&run](std::size_t i, unsigned worker) { run(i, worker); });
+}
+
+template<class Index>
+bool MonteCarlo::searchPath(const GraphContext<Index>& ctx, SearchContext<Index>& searcher, std::size_t densityIndex,
+                            int graphIndex, int searchIndex, SearchResult& result) {
+
+    double curDensity = m_densities[densityIndex];
+    BasicTraverser<Index> traverser = makeTraverser(ctx, searcher);
+    Index from, to;
+    pickEnds(densityIndex, graphIndex, searchIndex, from, to);
+
+    static const char* const names[] = {"BFS", "DFS", "BiBFS"};
+    result = SearchResult{-1, 0, 0, 0, 0, searchIndex};
+    bool success = true;
+    if (m_enabled[kMsBfs])
+    {
+        // пакетный поиск уже выполнен, его ошибки записаны в searchBatches
+        result.dist = ctx.batchDist[searchIndex];
+        result.msbfs = ctx.batchVisited[searchIndex];
+        success = result.dist >= 0;
+    }
+    if (m_enabled[kBfs] && ctx.cachedBfs[searchIndex] >= 0)
+        result.dist = ctx.cachedDist[searchIndex];
+    for (SearchKind kind : {kBfs, kDfs, kBiBfs})
     {
-        traverser.traverse<std::queue<SizeType>>(from, to, curDensity);  // BFS
-        m_bfsResults.push_back(traverser.getTraverseOrder().size());
-        m_dist.push_back(traverser.getPath().size() - 1); // -1, чтобы не учитывать первую вершину
+        // Расстояние нужно всегда: если ни один поиск в ширину не выбран, его даёт двунаправленный поиск
+        bool needDist = kind == kBiBfs && result.dist < 0 && !m_enabled[kMsBfs];
+        if (!m_enabled[kind] && !needDist)
+            continue;
+        // ответ уже известен из полного обхода
+        const List<int>& cached = kind == kBfs ? ctx.cachedBfs : ctx.cachedDfs;
+        if (kind != kBiBfs && cached[searchIndex] >= 0)
+        {
+            (kind == kBfs ? result.bfs : result.dfs) = cached[searchIndex];
+            continue;
+        }
         traverser.clear();
+        try
+        {
+            int visited = runSearch(traverser, kind, from, to, curDensity, result.dist, searcher.profile);
+            (kind == kBfs ? result.bfs : kind == kDfs ? result.dfs : result.bibfs) = visited;
+        }
+        catch (std::exception& exc)
+        {
+            std::lock_guard<std::mutex> lock(m_logMutex);
+            m_logger.errSearch(exc.what(), m_numVertices, curDensity, from, to, names[kind]);
+            logErrGraph(ctx);
+            success = false;
+        }
     }
-    catch (std::exception& exc)
+    return success;
+}
+
+template<class Index>
+void MonteCarlo::pickEnds(std::size_t densityIndex, int graphIndex, int searchIndex, Index& from,
+                          Index& to) const {
+    Randomizer rand = makeRandomizer(densityIndex, graphIndex, kFirstSearchStream + searchIndex);
+    from = rand.uRand(0, m_numVertices - 1);
+    to = from;
+    while (to == from)
+        to = rand.uRand(0, m_numVertices - 1);
+}
+
+template<class Index>
+void MonteCarlo::searchCached(GraphContext<Index>& ctx, std::size_t densityIndex, int graphIndex) {
+    ctx.cachedDist.assign(m_numSearches, -1);
+    ctx.cachedBfs.assign(m_numSearches, -1);
+    ctx.cachedDfs.assign(m_numSearches, -1);
+    if (m_options.orderCacheMin <= 0 || (!m_enabled[kBfs] && !m_enabled[kDfs]))
+        return;
+
+    // Поиски группируются по начальной вершине; внутри группы -- по номеру
+    List<Index>& from = ctx.from;
+    List<Index>& to = ctx.to;
+    List<int>& searches = ctx.bySource;
+    from.resize(m_numSearches);
+    to.resize(m_numSearches);
+    searches.resize(m_numSearches);
+    for (int searchIndex = 0; searchIndex < m_numSearches; ++searchIndex)
     {
-        m_logger.errSearch(exc.what(), m_numVertices, curDensity, from, to, "BFS");
-        m_logger.logErrGraph(m_graph);
+        pickEnds(densityIndex, graphIndex, searchIndex, from[searchIndex], to[searchIndex]);
+        searches[searchIndex] = searchIndex;
     }
+    // sort с номером вместо stable_sort: тот же порядок без временного буфера
+    std::sort(searches.begin(), searches.end(), [&](int a, int b)
+    {
+        return from[a] != from[b] ? from[a] < from[b] : a < b;
+    });
 
-    try
+    // Группы из orderCacheMin поисков и больше: [groups[g], groupEnds[g]) в searches
+    List<std::size_t>& groups = ctx.groups;
+    List<std::size_t>& groupEnds = ctx.groupEnds;
+    groups.clear();
+    groupEnds.clear();
+    for (std::size_t first = 0, last = 0; first < searches.size(); first = last)
     {
-        traverser.traverse<std::stack<SizeType>>(from, to, curDensity);  // DFS
-        m_dfsResults.push_back(traverser.getTraverseOrder().size());
+        while (last < searches.size() && from[searches[last]] == from[searches[first]])
+            ++last;
+        if (last - first >= static_cast<std::size_t>(m_options.orderCacheMin))
+        {
+            groups.push_back(first);
+            groupEnds.push_back(last);
+        }
     }
-    catch (std::exception& exc)
+
+    double curDensity = m_densities[densityIndex];
+    forEachSearch(groups.size(), [&](std::size_t group, unsigned searcherIndex)
+    {
+        SearchContext<Index>& searcher = ctx.searchers[searcherIndex];
+        BasicTraverser<Index> traverser = makeTraverser(ctx, searcher);
+        searcher.order.reserve(m_numVertices);
+        const std::size_t first = groups[group];
+        const std::size_t last = groupEnds[group];
+        Index source = from[searches[first]];
+        // Недостижимые цели остаются -1: их ищет searchPath и записывает ошибку как обычно
+        if (m_enabled[kBfs])
+        {
+            {
+                PROFILE_SCOPE(searcher.profile, kPhaseOrderCache);
+                searcher.order.template build<std::queue<Index>>(traverser, source, curDensity);
+            }
+            for (std::size_t i = first; i < last; ++i)
+                if (searcher.order.reached(to[searches[i]]))
+                {
+                    ctx.cachedBfs[searches[i]] = searcher.order.visited(to[searches[i]]);
+                    ctx.cachedDist[searches[i]] = searcher.order.distance(to[searches[i]]);
+                }
+        }
+        if (m_enabled[kDfs])
+        {
+            {
+                PROFILE_SCOPE(searcher.profile, kPhaseOrderCache);
+                searcher.order.template build<std::stack<Index>>(traverser, source, curDensity);
+            }
+            for (std::size_t i = first; i < last; ++i)
+                if (searcher.order.reached(to[searches[i]]))
+                    ctx.cachedDfs[searches[i]] = searcher.order.visited(to[searches[i]]);
+        }
+    });
+}
+
+template<class Index>
+void MonteCarlo::searchBatches(GraphContext<Index>& ctx, std::size_t densityIndex, int graphIndex) {
+    double curDensity = m_densities[densityIndex];
+    ctx.batchDist.assign(m_numSearches, -1);
+    ctx.batchVisited.assign(m_numSearches, 0);
+
+    const std::size_t batches = (m_numSearches + MultiSourceBfs::kLanes - 1) / MultiSourceBfs::kLanes;
+    forEachSearch(batches, [&](std::size_t batch, unsigned searcherIndex)
+    {
+        SearchContext<Index>& searcher = ctx.searchers[searcherIndex];
+        Index from[MultiSourceBfs::kLanes];
+        Index to[MultiSourceBfs::kLanes];
+        int first = static_cast<int>(batch) * MultiSourceBfs::kLanes;
+        int count = std::min(MultiSourceBfs::kLanes, m_numSearches - first);
+        for (int lane = 0; lane < count; ++lane)
+            pickEnds(densityIndex, graphIndex, first + lane, from[lane], to[lane]);
+        try
+        {
+            PROFILE_SCOPE(searcher.profile, kPhaseMsBfs);
+            searcher.batch.search(from, to, count, curDensity);
+        }
+        catch (std::exception& exc)
+        {
+            std::lock_guard<std::mutex> lock(m_logMutex);
+            // ошибка у всей пачки: записываются концы каждого её поиска, чтобы пачку можно было повторить
+            for (int lane = 0; lane < count; ++lane)
+                m_logger.errSearch(exc.what(), m_numVertices, curDensity, from[lane], to[lane],
+                                   "MS-BFS batch (search " + std::to_string(first + lane) + ")");
+            logErrGraph(ctx);
+            return;
+        }
+        for (int lane = 0; lane < count; ++lane)
+        {
+            ctx.batchDist[first + lane] = searcher.batch.getDistance(lane);
+            ctx.batchVisited[first + lane] = searcher.batch.getVisited(lane);
+        }
+    });
+}
+
+template<class Index>
+int MonteCarlo::runSearch(BasicTraverser<Index>& traverser, SearchKind kind, Index from, Index to, double density,
+                          int& dist, PhaseProfile* profile) {
+    switch (kind)
     {
-        m_logger.errSearch(exc.what(), m_numVertices, curDensity, from, to, "DFS");
-        m_logger.logErrGraph(m_graph);
+    case kBfs:
+    {
+        {
+            PROFILE_SCOPE(profile, kPhaseBfs);
+            if (m_options.hybridBfs)
+                traverser.traverseHybrid(from, to, density, m_options.bfsDirection);
+            else
+                traverser.template traverse<std::queue<Index>>(from, to, density);
+        }
+        PROFILE_SCOPE(profile, kPhasePath);
+        dist = traverser.getDistance();
+        break;
+    }
+    case kDfs:
+    {
+        PROFILE_SCOPE(profile, kPhaseDfs);
+        traverser.template traverse<std::stack<Index>>(from, to, density);
+        break;
+    }
+    case kBiBfs:
+    {
+        {
+            PROFILE_SCOPE(profile, kPhaseBiBfs);
+            traverser.traverseBidir(from, to, density);
+        }
+        PROFILE_SCOPE(profile, kPhasePath);
+        dist = traverser.getDistance();
+        break;
     }
+    case kMsBfs:
+        throw std::logic_error("MS-BFS searches run in batches");
+    }
+    return traverser.getTraverseOrder().size();
 }
 
 // Логирование результатов
-void MonteCarlo::logResults(int graphIndex, double density, int searchIndex) {
-    m_logger.log(m_graph.size(), density, m_dist.back(), getBFSResults().back(), getDFSResults().back());
+void MonteCarlo::logResults(std::size_t task, const TaskResult& result) {
+    double density = m_densities[densityOf(task)];
+    if (m_results)
+    {
+        for (const auto& search : result.searches)
+        {
+            m_results->push(static_cast<uint32_t>(m_numVertices));
+            m_results->push(density);
+            m_results->push(static_cast<uint32_t>(graphOf(task)));
+            m_results->push(static_cast<uint32_t>(search.index));
+            m_results->push(static_cast<uint32_t>(search.dist));
+            for (SearchKind kind : {kBfs, kDfs, kBiBfs, kMsBfs})
+                if (m_enabled[kind])
+                    m_results->push(static_cast<uint32_t>(visitedCount(search, kind)));
+            m_results->endRow();
+        }
+        return;
+    }
+
+    List<int> visited;
+    for (const auto& search : result.searches)
+    {
+        // столбцы только включённых методов, в фиксированном порядке
+        visited.clear();
+        for (SearchKind kind : {kBfs, kDfs, kBiBfs, kMsBfs})
+            if (m_enabled[kind])
+                visited.push_back(visitedCount(search, kind));
+        m_logger.log(m_numVertices, density, search.dist, visited);
+    }
     // TODO правильное логирование с ипользование геттеров
-}
\ No newline at end of file
+}
+
+void MonteCarlo::aggregate(std::size_t task, const TaskResult& result) {
+    SearchStats& stats = m_stats[densityOf(task)];
+    List<int> visited;
+    for (const auto& search : result.searches)
+    {
+        visited.clear();
+        for (SearchKind kind : {kBfs, kDfs, kBiBfs, kMsBfs})
+            if (m_enabled[kind])
+                visited.push_back(visitedCount(search, kind));
+        stats.add(search.dist, visited);
+    }
+
+    if (m_options.statsInterval > 0
+        && std::chrono::duration<double>(Clock::now() - m_statsWritten).count() >= m_options.statsInterval)
+    {
+        writeStats();
+        m_statsWritten = Clock::now();
+    }
+}
+
+void MonteCarlo::writeStats() const {
+    std::string tmpPath = m_options.statsPath + ".tmp";
+    {
+        std::ofstream out(tmpPath);
+        if (!out)
+            throw std::runtime_error("Error opening file " + tmpPath);
+        for (std::size_t i = 0; i < m_stats.size(); ++i)
+            m_stats[i].write(out, m_densities[i]);
+        if (!out)
+            throw std::runtime_error("Error writing file " + tmpPath);
+    }
+    std::filesystem::rename(tmpPath, m_options.statsPath);
+}
+
+Checkpoint MonteCarlo::emptyCheckpoint() const {
+    Checkpoint point;
+    point.seed = m_options.seed;
+    point.numVertices = m_numVertices;
+    point.numGraphs = m_numGraphs;
+    point.numSearches = m_numSearches;
+    point.densities = m_densities;
+    // потоки, представление графов и кэш обходов на результаты не влияют, поэтому их можно менять
+    std::string methods;
+    for (const auto& method : enabledMethods())
+        methods += (methods.empty() ? "" : ",") + method;
+    point.setup = "methods=" + methods
+        + ";ladder=" + std::to_string(m_options.densityLadder)
+        + ";log=" + (!m_options.rawLog ? "off" : m_options.resultsPath.empty() ? "text" : "binary")
+        + ";all-pairs=" + std::to_string(m_options.allPairs)
+        + ";stats=" + std::to_string(!m_options.statsPath.empty())
+        + ";snapshots=" + std::to_string(!m_options.snapshotDir.empty());
+    return point;
+}
+
+void MonteCarlo::checkpoint(std::size_t task) {
+    if (m_options.checkpointPath.empty())
+        return;
+    // лестница плотностей продолжается только с начала графа: состояние серии в точку не пишется
+    const std::size_t unitTasks = m_options.densityLadder ? m_densities.size() : 1;
+    const std::size_t tasks = m_densities.size() * m_numGraphs;
+    if ((task + 1) % unitTasks != 0)
+        return;
+    if (task + 1 < tasks
+        && std::chrono::duration<double>(Clock::now() - m_checkpointWritten).count() < m_options.checkpointInterval)
+        return;
+
+    Checkpoint point = emptyCheckpoint();
+    point.tasks = task + 1;
+    point.logSizes = m_logger.flush();
+    if (m_results)
+    {
+        m_results->flush();
+        point.resultsBytes = std::filesystem::file_size(m_options.resultsPath);
+    }
+    point.stats = m_stats;
+    point.write(m_options.checkpointPath);
+    m_checkpointWritten = Clock::now();
+}
+
+void MonteCarlo::resume() {
+    Checkpoint saved = Checkpoint::read(m_options.checkpointPath);
+    if (!saved.sameRun(emptyCheckpoint()))
+        throw std::runtime_error("Checkpoint " + m_options.checkpointPath
+                                 + " belongs to another run: seed, grid or output settings differ");
+
+    // вывод задач после контрольной точки мог быть записан частично -- он отбрасывается
+    m_logger.truncate(saved.logSizes);
+    if (m_options.rawLog && !m_options.resultsPath.empty())
+    {
+        if (std::filesystem::file_size(m_options.resultsPath) < saved.resultsBytes)
+            throw std::runtime_error("results file is shorter than the checkpoint");
+        std::filesystem::resize_file(m_options.resultsPath, saved.resultsBytes);
+    }
+    if (!m_stats.empty())
+        m_stats = saved.stats;
+    m_firstTask = saved.tasks;
+    m_nextCommit = m_firstTask;
+    std::cerr << "resuming after " << saved.tasks << " of " << m_densities.size() * m_numGraphs << " tasks\n";
+}
+
+void MonteCarlo::startProfile(unsigned workers) {
+    m_profiles.clear();
+    m_profileThreads = 0;
+    if (!ENABLE_PROFILE || m_options.profilePath.empty())
+        return;
+    m_profileThreads = workers;
+    m_profiles.assign(std::size_t(workers) * m_densities.size(), PhaseProfile());
+}
+
+PhaseProfile* MonteCarlo::profileFor(unsigned worker, std::size_t densityIndex) {
+    if (m_profiles.empty())
+        return nullptr;
+    return &m_profiles[worker * m_densities.size() + densityIndex];
+}
+
+void MonteCarlo::writeProfile() const {
+    const std::string& path = m_options.profilePath;
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath);
+        if (!out)
+            throw std::runtime_error("Error opening file " + tmpPath);
+        out << std::setprecision(10);
+        if (json)
+            out << "[";
+        else
+            PhaseProfile::writeCsvHeader(out);
+        bool first = true;
+        auto write = [&](const PhaseProfile& profile, const std::string& thread, double density)
+        {
+            if (json)
+            {
+                out << (first ? "\n  " : ",\n  ");
+                profile.writeJson(out, thread, density);
+            }
+            else
+                profile.writeCsv(out, thread, density);
+            first = false;
+        };
+        // Сначала профили потоков, затем итог по каждой плотности (thread = all)
+        for (unsigned worker = 0; worker < m_profileThreads; ++worker)
+            for (std::size_t i = 0; i < m_densities.size(); ++i)
+                write(m_profiles[worker * m_densities.size() + i], std::to_string(worker), m_densities[i]);
+        for (std::size_t i = 0; i < m_densities.size(); ++i)
+        {
+            PhaseProfile total;
+            for (unsigned worker = 0; worker < m_profileThreads; ++worker)
+                total.merge(m_profiles[worker * m_densities.size() + i]);
+            write(total, "all", m_densities[i]);
+        }
+        if (json)
+            out << "\n]\n";
+        if (!out)
+            throw std::runtime_error("Error writing file " + tmpPath);
+    }
+    std::filesystem::rename(tmpPath, path);
+}
+
+int MonteCarlo::visitedCount(const SearchResult& search, SearchKind kind) {
+    switch (kind)
+    {
+    case kBfs:
+        return search.bfs;
+    case kDfs:
+        return search.dfs;
+    case kBiBfs:
+        return search.bibfs;
+    case kMsBfs:
+        return search.msbfs;
+    }
+    return 0;
+}
+
+List<results_format::Column> MonteCarlo::resultColumns() const {
+    using namespace results_format;
+    List<Column> columns{{"n", kUInt32}, {"density", kFloat64}, {"graph", kUInt32}, {"search", kUInt32},
+                         {"dist", kUInt32}};
+    for (const auto& method : enabledMethods())
+        columns.push_back({method, kUInt32});
+    return columns;
+}
+
+List<std::string> MonteCarlo::enabledMethods() const {
+    static const char* const names[] = {"bfs", "dfs", "bibfs", "msbfs"};
+    List<std::string> methods;
+    for (SearchKind kind : {kBfs, kDfs, kBiBfs, kMsBfs})
+        if (m_enabled[kind])
+            methods.push_back(names[kind]);
+    return methods;
+}
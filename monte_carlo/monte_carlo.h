@@ -2,47 +2,307 @@
 #ifndef MONTE_CARLO_H
 #define MONTE_CARLO_H
 
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
 #include "common/common.h"
 #include "graph/tree.h"
+#include "graph/bit_matrix.h"
+#include "graph/csr.h"
+#include "graph/density_ladder.h"
+#include "graph/edge.h"
 #include "graph/traversal.h"
+#include "graph/workspace.h"
+#include "graph/ms_bfs.h"
+#include "graph/order_cache.h"
+#include "graph/snapshot.h"
 #include "logger/logger.h"
+#include "logger/results_writer.h"
+#include "monte_carlo/checkpoint.h"
+#include "parallel/work_stealing_pool.h"
+#include "randomizer/rand.h"
+#include "stats/phase_profile.h"
+#include "stats/search_stats.h"
+
+// Сравниваемые методы поиска
+enum SearchKind
+{
+    kBfs,     // Поиск в ширину
+    kDfs,     // Поиск в глубину
+    kBiBfs,   // Двунаправленный поиск в ширину
+    kMsBfs    // Поиски графа пачками по 64 (MS-BFS); число посещённых вершин -- по уровням
+};
+
+// Представление графов в памяти
+enum GraphStorage
+{
+    kStorageAuto,     // Для каждой плотности -- меньшее из CSR и битовой матрицы
+    kStorageCsr,      // Списки смежности (для высоких плотностей -- дополнения)
+    kStorageMatrix    // Битовая матрица смежности n x n
+};
+
+// Настройки запуска эксперимента
+struct MonteCarloOptions
+{
+    int numThreads = 1;   // Число потоков: 1 -- последовательный запуск, 0 -- по числу ядер
+    int searchThreads = 1;   // Потоки поисков одного графа (графы тогда строятся по одному), 0 -- по числу ядер
+    uint64_t seed = 0;    // Главная затравка: все случайные потоки эксперимента выводятся из неё
+    List<SearchKind> searches{kBfs, kDfs};   // Методы поиска; столбцы лога идут в порядке kBfs, kDfs, kBiBfs, kMsBfs
+    bool allPairs = false;                   // Записывать распределение расстояний между всеми парами вершин
+    std::string resultsPath;                 // Двоичный файл результатов вместо текстового лога (если задан)
+    bool rawLog = true;                      // Записывать результат каждого поиска (лог или resultsPath)
+    std::string statsPath;                   // Файл сводок по плотностям (если задан)
+    double statsInterval = 0;                // Период перезаписи сводок во время работы, с (0 -- только в конце)
+    std::string profilePath;                 // Профиль этапов по плотностям и потокам: CSV или JSON (*.json)
+    std::string snapshotDir;                 // Каталог снимков: графы читаются из него, а не генерируются
+    std::string writeSnapshotDir;            // Каталог, куда записываются снимки построенных графов
+    GraphStorage storage = kStorageAuto;     // Представление графов (снимки всегда в CSR)
+    bool hybridBfs = false;                  // Поиск в ширину с выбором направления (traverseHybrid)
+    DirectionHeuristic bfsDirection;         // Пороги переключения направления при hybridBfs
+    int orderCacheMin = 4;                   // Поиски из вершины, начиная с которых BFS/DFS берутся из полного
+                                             // обхода (BasicOrderCache); 0 -- всегда обход с ранним выходом
+    bool densityLadder = false;              // Графы всех плотностей строятся из одного дерева, вложенными
+                                             // (BasicDensityLadder); задачи идут по графам, а не по плотностям
+    std::string checkpointPath;              // Файл контрольных точек (если задан)
+    double checkpointInterval = 300;         // Период записи контрольных точек, с (и всегда -- в конце)
+    bool resume = false;                     // Продолжить с контрольной точки: выполненные задачи пропускаются,
+                                             // лог обрезается до её размеров и дописывается
+};
 
 class MonteCarlo {
 public:
-    MonteCarlo(const List<double>& densities, int numVertices, int numGraphs, int numSearches, Logger& log);
+    MonteCarlo(const List<double>& densities, int numVertices, int numGraphs, int numSearches, Logger& log,
+               const MonteCarloOptions& options = MonteCarloOptions());
 
     // Очищение графов и результатов
     void clear();
 
-    // Геттеры для результатов
+    // Геттеры для результатов (последнего обработанного графа)
     const List<int>& getBFSResults() const;
     const List<int>& getDFSResults() const;
+    const List<int>& getBiBFSResults() const;
+    const List<int>& getMsBFSResults() const;
 
     // Инициализация алгоритма, запускает метод
     void initialize();
 
 private:
-    // Метод для построения графа
-    List<Node> buildGraph(int numEdges, double density);
+    // Назначение случайного потока внутри единицы работы (плотность, граф)
+    enum StreamPurpose : uint64_t
+    {
+        kTreeStream = 0,          // Последовательность Прюфера
+        kEdgesStream = 1,         // Добавляемые или удаляемые рёбра
+        kFirstSearchStream = 2    // Концы пути поиска с номером s: kFirstSearchStream + s
+    };
+
+    // Координата плотности потоков в лестнице плотностей: все плотности графа берут общие случайные числа
+    static constexpr uint64_t kLadderStreams = ~uint64_t(0);
+
+    // Результат одного поиска
+    struct SearchResult
+    {
+        int dist;   // Геодезическое расстояние
+        int bfs;    // Число посещённых вершин при поиске в ширину
+        int dfs;    // Число посещённых вершин при поиске в глубину
+        int bibfs;  // Число посещённых вершин при двунаправленном поиске в ширину
+        int msbfs;  // Число вершин ближе цели плюс цель (пакетный поиск)
+        int index;  // Номер поиска на графе
+    };
+
+    // Результаты одной единицы работы -- графа с номером graphIndex для плотности densityIndex
+    struct TaskResult
+    {
+        List<SearchResult> searches;
+        List<uint64_t> distances; // Распределение расстояний между всеми парами (при allPairs)
+        double searchTime = 0;   // Время всех поисков на графе, мкс
+        bool ready = false;      // Задача выполнена, но ещё не записана в лог
+    };
+
+    // Буферы одного потока поисков: граф общий и только читается, рабочая память у каждого своя
+    template<class Index>
+    struct SearchContext
+    {
+        BasicTraversalWorkspace<Index> workspace;
+        BasicMultiSourceBfs<Index> batch;   // Пакетный поиск по графу
+        BasicOrderCache<Index> order;       // Полный обход из начальной вершины группы поисков
+        PhaseProfile* profile = nullptr;    // Профиль потока для текущей плотности (nullptr -- замеры выключены)
+    };
+
+    // Буферы одного потока задач: граф и рабочая память его поисков (Index -- тип номера вершины)
+    template<class Index>
+    struct GraphContext
+    {
+        BasicCsrGraph<Index> graph;         // Граф в CSR; при useMatrix -- только его остовное дерево
+        BasicBitMatrixGraph<Index> matrix;  // Граф в виде битовой матрицы (при useMatrix)
+        bool useMatrix = false;             // Текущий граф построен в matrix
+        BasicBuildBuffers<Index> build;     // Рабочие списки построения графа
+        BasicDensityLadder<Index> ladder;   // Рёбра текущего графа серии (при densityLadder)
+        List<SearchContext<Index>> searchers;   // По одному на поток поисков (без пула поисков -- один)
+        List<int> batchDist;            // Расстояния поисков графа из пачек (-1 -- поиск не удался)
+        List<int> batchVisited;         // Посещённые вершины поисков графа из пачек
+        List<int> cachedDist;           // Расстояния поисков, отвеченных полным поиском в ширину (-1 -- нет)
+        List<int> cachedBfs;            // Посещённые вершины по полному поиску в ширину (-1 -- искать заново)
+        List<int> cachedDfs;            // То же для поиска в глубину
+        List<Index> from;               // Начальные вершины поисков графа
+        List<Index> to;                 // Конечные вершины поисков графа
+        List<int> bySource;             // Номера поисков, упорядоченные по начальной вершине
+        List<std::size_t> groups;       // Границы групп поисков с общей начальной вершиной в bySource
+        List<std::size_t> groupEnds;
+        List<SearchResult> searches;    // Результат каждого поиска графа по номеру
+        List<char> succeeded;           // Поиск с этим номером завершился без ошибок
+        PhaseProfile* profile = nullptr;    // Профиль текущей задачи (nullptr -- замеры выключены)
+        std::unique_ptr<GraphSnapshot> snapshot;   // Снимок, к которому привязан graph (при snapshotDir)
+    };
+
+    // Метод для построения графа с номером graphIndex для плотности с номером densityIndex
+    template<class Index>
+    void buildGraph(GraphContext<Index>& ctx, std::size_t densityIndex, int graphIndex);
+
+    // Выбирает представление графов каждой плотности (m_useMatrix) по options.storage
+    template<class Index>
+    void chooseStorage();
+
+    // Записывает в лог ошибок текущий граф потока
+    template<class Index>
+    void logErrGraph(const GraphContext<Index>& ctx);
+
+    // Привязывает ctx.graph к снимку графа из snapshotDir; std::runtime_error, если снимок от другой сетки
+    template<class Index>
+    void loadSnapshot(GraphContext<Index>& ctx, std::size_t densityIndex, int graphIndex);
+
+    // Концы пути для поиска с номером searchIndex
+    template<class Index>
+    void pickEnds(std::size_t densityIndex, int graphIndex, int searchIndex, Index& from, Index& to) const;
+
+    // Все поиски графа пачками MS-BFS; результаты -- в ctx.batchDist и ctx.batchVisited
+    template<class Index>
+    void searchBatches(GraphContext<Index>& ctx, std::size_t densityIndex, int graphIndex);
+
+    // Поиски в ширину и в глубину из начальных вершин, с которых начинается не меньше orderCacheMin
+    // поисков графа, -- по одному полному обходу на вершину; ответы -- в ctx.cachedBfs и ctx.cachedDfs
+    template<class Index>
+    void searchCached(GraphContext<Index>& ctx, std::size_t densityIndex, int graphIndex);
+
+    // Метод для выполнения поиска пути на графе в рабочей памяти searcher; false, если поиск завершился ошибкой
+    template<class Index>
+    bool searchPath(const GraphContext<Index>& ctx, SearchContext<Index>& searcher, std::size_t densityIndex,
+                    int graphIndex, int searchIndex, SearchResult& result);
+
+    // Обходчик графа потока ctx в рабочей памяти searcher
+    template<class Index>
+    BasicTraverser<Index> makeTraverser(const GraphContext<Index>& ctx, SearchContext<Index>& searcher) const;
+
+    // Выполняет run(i, searcher) для i из [0, count), searcher -- номер потока поисков:
+    // в пуле поисков, если он есть, иначе по порядку в вызывающем потоке (searcher == 0)
+    template<class Run>
+    void forEachSearch(std::size_t count, Run&& run);
 
-    // Метод для выполнения поиска пути на графе
-    void searchPath(double curDensity);
+    // Один поиск методом kind; возвращает число посещённых вершин, dist -- длину пути (для поисков в ширину)
+    template<class Index>
+    int runSearch(BasicTraverser<Index>& traverser, SearchKind kind, Index from, Index to, double density,
+                  int& dist, PhaseProfile* profile);
 
-    // логирование результатов
-    void logResults(int graphIndex, double density, int searchIndex);
+    // Генератор для единицы работы: зависит только от затравки и координат, а не от порядка выполнения
+    Randomizer makeRandomizer(std::size_t densityIndex, int graphIndex, uint64_t purpose) const;
+
+    // Номер плотности задачи task: задачи идут по плотностям, а в лестнице -- по графам,
+    // внутри графа по возрастанию плотности
+    std::size_t densityOf(std::size_t task) const;
+
+    // Номер графа задачи task
+    int graphOf(std::size_t task) const;
+
+    // Построение графа и все поиски на нём для задачи с номером task, выполняемой потоком worker
+    template<class Index>
+    void runTask(GraphContext<Index>& ctx, std::size_t task, TaskResult& result, unsigned worker);
+
+    // Последовательный режим: задачи выполняются по порядку в вызывающем потоке
+    template<class Index>
+    void runSequential();
+
+    // Параллельный режим: задачи (плотность, граф) выполняются пулом потоков с перехватом задач;
+    // в лестнице плотностей единица работы пула -- все плотности одного графа
+    template<class Index>
+    void runParallel();
+
+    // Запись результатов задачи в лог и вывод прогресса; задачи передаются строго по порядку
+    void commitTask(std::size_t task, const TaskResult& result, unsigned worker);
+
+    // логирование результатов задачи с номером task (в текстовый лог или в двоичный файл)
+    void logResults(std::size_t task, const TaskResult& result);
+
+    // Добавляет поиски задачи в сводку её плотности
+    void aggregate(std::size_t task, const TaskResult& result);
+
+    // Контрольная точка без выполненных задач: затравка, сетка и настройки, от которых зависит вывод
+    Checkpoint emptyCheckpoint() const;
+
+    // Пишет контрольную точку после записи задачи task, если подошёл срок и задача завершает единицу работы
+    void checkpoint(std::size_t task);
+
+    // Продолжает с контрольной точки: обрезает вывод до её размеров, восстанавливает сводки и m_firstTask
+    void resume();
+
+    // Записывает сводки всех плотностей в statsPath (через временный файл, чтобы не оставить обрезанный)
+    void writeStats() const;
+
+    // Готовит профили этапов для workers потоков (если профиль включён)
+    void startProfile(unsigned workers);
+
+    // Профиль потока worker для плотности densityIndex; nullptr, если замеры выключены
+    PhaseProfile* profileFor(unsigned worker, std::size_t densityIndex);
+
+    // Записывает профили этапов в profilePath: по потокам и итог по каждой плотности
+    void writeProfile() const;
+
+    // Число посещённых вершин методом kind
+    static int visitedCount(const SearchResult& search, SearchKind kind);
+
+    // Имена включённых методов поиска в порядке столбцов
+    List<std::string> enabledMethods() const;
+
+    // Схема двоичного файла результатов: общие столбцы и по столбцу на каждый включённый метод
+    List<results_format::Column> resultColumns() const;
+
+    using Clock = std::chrono::steady_clock;
 
     List<double> m_densities;      // Вектор плотностей
     int m_numVertices;                    // Количество вершин в графе
     int m_numGraphs;                      // Количество графов для генерации
     int m_numSearches;                    // Количество поисков на каждом графе
+    MonteCarloOptions m_options;
+
+    std::unique_ptr<WorkStealingPool> m_searchPool;   // Пул поисков одного графа (при searchThreads != 1)
+    List<TaskResult> m_pending;           // Выполненные задачи, ждущие своей очереди на запись
+    std::size_t m_nextCommit = 0;         // Номер следующей задачи для записи в лог
+    std::size_t m_firstTask = 0;          // Первая невыполненная задача (не 0 при продолжении)
+    std::mutex m_logMutex;                // Защищает логгер и очередь записи
 
-    List<Node> m_graph;                   // Граф
     List<int> m_bfsResults;        // Результаты поиска в ширину
     List<int> m_dfsResults;        // Результаты поиска в глубину
-    List<int> m_dist;              // Геодезическое расстояние 
+    List<int> m_bibfsResults;      // Результаты двунаправленного поиска в ширину
+    List<int> m_msbfsResults;      // Результаты пакетного поиска в ширину
+    bool m_enabled[4] = {};        // Включён ли метод поиска (индекс -- SearchKind)
+    List<bool> m_useMatrix;        // Графы плотности хранятся битовой матрицей
+    List<std::size_t> m_ladder;    // Номера плотностей по возрастанию (порядок задач графа в лестнице)
+    List<int> m_dist;              // Геодезическое расстояние
     // TODO: добавить доп. данные методов
 
+    // Статистика прогресса
+    Clock::time_point m_begin;
+    Clock::time_point m_iter;
+    double m_avg = 0;
+
     Logger& m_logger;
+    std::unique_ptr<ResultsWriter> m_results;   // Двоичный файл результатов (если задан resultsPath)
+    List<SearchStats> m_stats;                  // Сводки по плотностям (если задан statsPath)
+    Clock::time_point m_statsWritten;           // Время последней записи сводок
+    Clock::time_point m_checkpointWritten;      // Время последней контрольной точки
+    List<PhaseProfile> m_profiles;              // Профили этапов: [поток * число плотностей + плотность]
+    unsigned m_profileThreads = 0;              // Число потоков, для которых заведены профили
 };
 
-#endif // MONTE_CARLO_H
\ No newline at end of file
+#endif // MONTE_CARLO_H
@@ -0,0 +1,120 @@
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned numThreads)
+{
+    if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < numThreads; ++i)
+        m_queues.push_back(std::make_unique<TaskQueue>());
+    for (unsigned i = 1; i < numThreads; ++i)
+        m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+unsigned WorkStealingPool::size() const
+{
+    return static_cast<unsigned>(m_queues.size());
+}
+
+void WorkStealingPool::run(std::size_t count, const Task& task)
+{
+    // раздаём задачи вперемешку, чтобы дорогие задачи не скапливались в одной очереди
+    for (std::size_t i = 0; i < count; ++i)
+        m_queues[i % size()]->tasks.push_back(i);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_error = nullptr;
+        m_running = static_cast<unsigned>(m_threads.size());
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_running == 0; });
+    m_task = nullptr;
+    if (m_error)
+        std::rethrow_exception(m_error);
+}
+
+void WorkStealingPool::workerLoop(unsigned worker)
+{
+    std::size_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop)
+                return;
+            seen = m_generation;
+        }
+        drain(worker);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_running;
+        }
+        m_done.notify_one();
+    }
+}
+
+void WorkStealingPool::drain(unsigned worker)
+{
+    std::size_t index;
+    // новые задачи во время запуска не появляются, поэтому пустые очереди означают конец работы
+    while (popOwn(worker, index) || steal(worker, index))
+    {
+        try
+        {
+            (*m_task)(index, worker);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error)
+                m_error = std::current_exception();
+        }
+    }
+}
+
+bool WorkStealingPool::popOwn(unsigned worker, std::size_t& index)
+{
+    auto& queue = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    index = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned worker, std::size_t& index)
+{
+    // обходим соседей по кругу, начиная со следующего потока
+    for (unsigned shift = 1; shift < size(); ++shift)
+    {
+        auto& queue = *m_queues[(worker + shift) % size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+        index = queue.tasks.back();
+        queue.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
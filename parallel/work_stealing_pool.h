@@ -0,0 +1,83 @@
+#pragma once
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "common/common.h"
+
+/**
+ * Пул потоков с перехватом задач (work stealing).
+ *
+ * @details
+ *      Задачи -- это индексы из [0, count). Перед запуском они раздаются по очередям потоков
+ *      вперемешку (индекс i попадает в очередь i % size()), так что у каждого потока оказываются
+ *      и дешёвые, и дорогие задачи. Поток берёт задачи из начала своей очереди (в порядке
+ *      возрастания индексов), а опустевший поток забирает задачи с конца чужих очередей.
+ *      Поэтому неравномерная стоимость задач не приводит к простою, как при статическом разбиении.
+ *
+ *      Вызывающий run() поток сам работает как поток с номером 0.
+ */
+class WorkStealingPool
+{
+public:
+    // Функция задачи: индекс задачи и номер потока, в котором она выполняется
+    using Task = std::function<void(std::size_t index, unsigned worker)>;
+
+    /**
+     * @param numThreads общее число потоков, включая вызывающий; 0 -- по числу ядер
+     */
+    explicit WorkStealingPool(unsigned numThreads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * Выполняет task для всех индексов из [0, count) и дожидается завершения
+     *
+     * @throw первое исключение, выброшенное задачей (остальные задачи при этом дорабатывают)
+     */
+    void run(std::size_t count, const Task& task);
+
+    // Общее число потоков
+    unsigned size() const;
+
+private:
+    // Очередь задач одного потока
+    struct TaskQueue
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    // Главный цикл фонового потока
+    void workerLoop(unsigned worker);
+
+    // Выполняет задачи, пока они есть в своей или чужих очередях
+    void drain(unsigned worker);
+
+    bool popOwn(unsigned worker, std::size_t& index);
+    bool steal(unsigned worker, std::size_t& index);
+
+    List<std::unique_ptr<TaskQueue>> m_queues;
+    List<std::thread> m_threads;
+
+    std::mutex m_mutex;                 // Защищает поля ниже
+    std::condition_variable m_wake;     // Появилась работа или пора завершаться
+    std::condition_variable m_done;     // Фоновый поток закончил текущий запуск
+    const Task* m_task = nullptr;
+    std::size_t m_generation = 0;       // Номер текущего запуска run()
+    unsigned m_running = 0;             // Фоновые потоки, ещё занятые текущим запуском
+    bool m_stop = false;
+    std::exception_ptr m_error;
+};
+
+#endif // WORK_STEALING_POOL_H
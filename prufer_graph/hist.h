@@ -2,15 +2,23 @@
 #ifndef HIST_H
 #define HIST_H
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
 #include "common/common.h"
 #include "common/service.h"
+#include "graph/edge.h"
+#include "prufer_graph/prufer.h"
+#include "randomizer/rand.h"
 
 
 
-// Функция для анализа распределения степеней вершин
-std::vector<SizeType> calculate_deg(int n, const std::vector<std::pair<SizeType, SizeType>> &pairs)
+// Функция для анализа распределения степеней вершин (Index -- тип номера вершины)
+template <class Index>
+std::vector<Index> calculate_deg(int n, const std::vector<std::pair<Index, Index>> &pairs)
 {
-    std::vector<SizeType> deg(n, 0);
+    std::vector<Index> deg(n, 0);
     for (int i = 0; i < pairs.size(); i++)
     {
         deg.at(pairs.at(i).first - 1) += 1; // индексация вершин с 1, а не с нуля
@@ -22,84 +30,122 @@ std::vector<SizeType> calculate_deg(int n, const std::vector<std::pair<SizeType,
 
 /**
  * Функция для генерации выборки степеней вершин
+ *
+ * @details
+ *      Новые пары выбираются последовательной выборкой (samplePairs) из пар, не входящих в дерево,
+ *      и сразу добавляются в счётчик степеней: ни список доступных пар, ни сами новые пары не хранятся.
+ *
  * @param n Количество вершин в графе
- * @param existing_pairs Список пар, уже существующих в графе (остовном дереве)
+ * @param existing_pairs Список пар, уже существующих в графе (остовном дереве), вершины нумеруются с 1
  * @param density Плотность графа (от 0 до 1)
+ * @param rand Генератор случайных чисел
  * @return Вектор, содержащий степени всех вершин
- * @complexity O(n + l)
- * @time O(n + l)
- * @space O(n + l)
+ * @complexity O(n + l + existing_pairs.size() * log)
+ * @space O(n + existing_pairs.size())
  */
-std::vector<SizeType> generate_degree_sample(
-    int n, const std::vector<std::pair<SizeType, SizeType>> &existing_pairs, double density)
+template <class Index>
+std::vector<Index> generate_degree_sample(
+    int n, const std::vector<std::pair<Index, Index>> &existing_pairs, double density, Randomizer &rand)
 {
-    SizeType T = n * (n - 1) / 2; // Общее количество возможных пар
-    std::vector<SizeType> deg(n, 0);
-
-    // Используем unordered_set для быстрого поиска
-    std::unordered_set<SizeType> existing_set;
-    for (const auto &pair : existing_pairs)
-    {
-        existing_set.insert((pair.first - 1) * (2 * n - pair.first) / 2 + (pair.second - pair.first - 1));
-    }
-
-    // Определяем l — сколько новых пар нужно добавить
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    // Номера пар считаются в uint64_t: n * (n - 1) / 2 не помещается в номер вершины
+    uint64_t T = static_cast<uint64_t>(n) * (n - 1) / 2; // Общее количество возможных пар
 
     if (density > 1 || density < 0)
         throw std::invalid_argument("Некорректная плотность");
 
-    int l = int(double(T) * density);
+    // Определяем l — сколько новых пар нужно добавить
+    uint64_t l = static_cast<uint64_t>(double(T) * density);
     if (l == 0)
     {
-        std::uniform_int_distribution<int> dist(0, T - existing_pairs.size());
-        l = dist(gen);
+        // смещение остатка от деления 64-битного числа пренебрежимо
+        uint64_t word = (static_cast<uint64_t>(rand()) << 32) | rand();
+        l = word % (T - existing_pairs.size() + 1);
     }
+    l = std::min<uint64_t>(l, T - existing_pairs.size()); //< больше свободных пар не выбрать
 
-    // std::cout << "Number of new pairs to generate: l = " << l << std::endl;
-    // std::cout << "With density = " << double(l + n - 1)/double(T) << std::endl;
+    std::vector<Index> deg = calculate_deg(n, existing_pairs);
     if (l == 0)
     {
-        return calculate_deg(n, existing_pairs);
+        return deg;
     }
-    // Генерация списка доступных индексов (не входящих в existing_pairs)
-    std::vector<SizeType> available_indices;
-    available_indices.reserve(T - existing_pairs.size());
 
-    for (SizeType i = 0; i < T; i++)
+    // Запрещённые пары -- отсортированный список рёбер с нумерацией с 0
+    List<BasicEdge<Index>> exclude;
+    exclude.reserve(existing_pairs.size());
+    for (const auto &pair : existing_pairs)
+        exclude.push_back(normalizeEdge<Index>(pair.first - 1, pair.second - 1));
+    std::sort(exclude.begin(), exclude.end());
+
+    samplePairs(static_cast<Index>(n), exclude, l, rand, [&deg](Index a, Index b)
     {
-        if (existing_set.find(i) == existing_set.end())
-        {
-            available_indices.push_back(i);
-        }
-    }
-    // std::cout << "l to generate l = " << l << std::endl;
-    //  Выбор l случайных индексов с помощью std::sample
-    std::vector<SizeType> new_pairs;
-    new_pairs.reserve(l);
-    std::sample(available_indices.begin(), available_indices.end(), std::back_inserter(new_pairs), l, gen);
+        ++deg[a];
+        ++deg[b];
+    });
+    return deg;
+}
 
-    // Формируем итоговый список пар
-    std::vector<std::pair<SizeType, SizeType>> graph_pairs;
-    graph_pairs.reserve(existing_pairs.size() + l);
+/**
+ * Степени вершин случайного графа, построенного по последовательности Прюфера, без списков смежности
+ *
+ * @details
+ *      Степень вершины дерева -- число её вхождений в последовательность плюс один. Рёбра дерева
+ *      распаковываются только в отсортированный список (их нельзя выбрать повторно), добавляемые
+ *      рёбра идут из samplePairs прямо в счётчик степеней. При density >= MIN_INVERSE_DENSITY, как
+ *      в inverseGraph, выбираются удалённые рёбра, и степень -- n - 1 минус число удалённых рёбер
+ *      вершины. Выборки и их параметры те же, что в setGraphDensity, поэтому при том же состоянии
+ *      rand степени совпадают со степенями графа, построенного по CSR.
+ *
+ * @param prufer_sequence Последовательность Прюфера остовного дерева (вершины нумеруются с 1)
+ * @param n Количество вершин
+ * @param density Плотность графа
+ * @param rand Генератор случайных чисел для добавляемых (удаляемых) рёбер
+ * @param[out] degree степени вершин (нумерация с 0)
+ * @param edges рабочий список рёбер, переиспользуемый между вызовами
+ * @complexity O(n log n + m), m -- число добавляемых (удаляемых) рёбер
+ */
+template <class Index>
+void sample_degrees(const List<int> &prufer_sequence, int n, double density, Randomizer &rand,
+                    List<Index> &degree, List<BasicEdge<Index>> &edges)
+{
+    prufer_degrees(prufer_sequence, n, degree);
+    std::size_t maxEdges = static_cast<std::size_t>(n) * (n - 1) / 2;
+    std::size_t treeEdges = n > 0 ? n - 1 : 0;
+    std::size_t needMinEdges = std::round(maxEdges * density);
+    if (density < MIN_INVERSE_DENSITY && treeEdges >= needMinEdges)
+        return; //< дерево уже достаточно плотное
+
+    // рёбра дерева; распаковка портит degree, поэтому степени потом считаются заново
+    edges.clear();
+    prufer_decode(prufer_sequence, n, degree, [&edges](Index u, Index v)
+    {
+        edges.push_back(normalizeEdge(u, v));
+    });
+    std::sort(edges.begin(), edges.end());
 
-    for (SizeType idx : new_pairs)
+    Randomizer replay = rand; //< как в setGraphDensity: сам rand не продвигается
+    if (density >= MIN_INVERSE_DENSITY)
     {
-        auto pair = pair_from_index(idx, n);
-        deg.at(pair.first - 1) += 1; // индексация вершин с 1, а не с 0
-        deg.at(pair.second - 1) += 1;
+        degree.assign(n, static_cast<Index>(n - 1));
+        samplePairs(static_cast<Index>(n), edges, removedEdgesCount(n, density), replay, [&degree](Index a, Index b)
+        {
+            --degree[a];
+            --degree[b];
+        });
+        return;
     }
-    for (auto idx : existing_pairs)
+
+    prufer_degrees(prufer_sequence, n, degree);
+    uint64_t toAdd = std::min<uint64_t>(needMinEdges - treeEdges, maxEdges - treeEdges);
+    samplePairs(static_cast<Index>(n), edges, toAdd, replay, [&degree](Index a, Index b)
     {
-        deg.at(idx.first - 1) += 1;
-        deg.at(idx.second - 1) += 1;
-    }
-    return deg;
+        ++degree[a];
+        ++degree[b];
+    });
 }
 
 // получение гистограммы по массиву степеней
-std::vector<int> get_hist(int n, const std::vector<SizeType> &deg, std::vector<int> &hist)
+template <class Index>
+std::vector<int> get_hist(int n, const std::vector<Index> &deg, std::vector<int> &hist)
 {
 
     for (auto i : deg)
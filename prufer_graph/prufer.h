@@ -3,31 +3,34 @@
 #define PRUFER_H
 
 #include "randomizer/rand.h"
-#include <chrono>
 #include "common/common.h"
-#include <queue>
+#include "graph/csr.h"
+#include <stdexcept>
 /**
  * Функция для генерации последовательности Прюфера
  * @param n Количество вершин в дереве
- * @return Вектор, содержащий последовательность Прюфера
+ * @param rand Генератор случайных чисел; у каждого дерева свой поток, поэтому деревья,
+ *             построенные одновременно в разных потоках выполнения, независимы
+ * @param[out] prufer_sequence последовательность Прюфера (память списка переиспользуется)
  * @complexity O(n)
  * @time O(n)
  * @space O(n)
  */
-List<int> prufer_gen(int n)
+void prufer_gen(int n, Randomizer& rand, List<int>& prufer_sequence)
 {
-    List<int> prufer_sequence(n - 2);
-
-    // Используем текущее время как начальное значение для генератора
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::mt19937 gen(seed);
-    std::uniform_int_distribution<> dist(1, n);
+    prufer_sequence.resize(n - 2);
 
     for (int i = 0; i < n - 2; ++i)
     {
-        prufer_sequence.at(i) = dist(gen);
+        prufer_sequence[i] = rand.rand(1, n);
     }
+}
 
+// То же с новым списком
+List<int> prufer_gen(int n, Randomizer& rand)
+{
+    List<int> prufer_sequence;
+    prufer_gen(n, rand, prufer_sequence);
     return prufer_sequence;
 }
 
@@ -44,13 +47,14 @@ List<int> prufer_gen(int n)
  * 
  * @param[in] n Количество запрошенных уникальных чисел
  * @param[in] diap Диапазон, из которого берутся числа
+ * @param[in] rand Генератор случайных чисел
  * @return std::vector<SizeType> - последовательность из n уникальных чисел
  * @complexity O(n)
  * @time O(n)
  * @space O(n)
  * @throw std::invalid_argument - если n > diap
  */
-std::vector<SizeType> seq_gen(int n, SizeType diap)
+std::vector<SizeType> seq_gen(int n, SizeType diap, Randomizer& rand)
 {
     if (n > diap)
     {
@@ -63,76 +67,136 @@ std::vector<SizeType> seq_gen(int n, SizeType diap)
         seq.at(i) = i + 1; // Заполняем диапазон значениями от 1 до diap
     }
 
-    // Инициализируем генератор случайных чисел
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::shuffle(seq.begin(), seq.end(), std::mt19937(seed));
+    // Перемешиваем переданным генератором
+    rand.shuffle(seq);
 
     // Берём первые n уникальных элементов
     return std::vector<SizeType>(seq.begin(), seq.begin() + n);
 }
 
 /**
- * Функция для восстановления дерева из последовательности Прюфера
- * Оптимизированная реализация
- * @param prufer_sequence Последовательность Прюфера
+ * Линейное восстановление дерева из последовательности Прюфера
+ *
+ * @details
+ *      Вместо кучи минимальных листьев используется указатель ptr на наименьший ещё не
+ *      использованный лист и переменная leaf с текущим листом. Если после удаления листа
+ *      вершина последовательности сама становится листом и она меньше ptr, она и будет
+ *      следующим минимальным листом; иначе ptr сдвигается вперёд к следующему листу.
+ *      Указатель только растёт, поэтому весь проход стоит O(n).
+ *
+ * @param prufer_sequence Последовательность Прюфера (вершины нумеруются с 1)
  * @param n Количество вершин в дереве
- * @return Вектор пар, представляющий дерево
+ * @param[in, out] degree рабочий массив: на выходе -- не степени, а остаток после распаковки
+ * @param placeEdge вызывается для каждого ребра дерева (вершины нумеруются с 0)
+ * @throw std::out_of_range если в последовательности есть несуществующая вершина
  * @complexity O(n)
- * @time O(n)
- * @space O(n)
- * Версия с сортировкой вершин
  */
-List<EdgeType> prufer_unpack(const std::vector<int> &prufer_sequence, int n)
+template <class Index, class EdgeSink>
+void prufer_decode(const List<int> &prufer_sequence, int n, List<Index> &degree, EdgeSink &&placeEdge)
 {
-    List<EdgeType> edges;
-
-    // Массив для отслеживания количества появлений каждой вершины в последовательности Прюфера
-    std::vector<SizeType> degree(n + 1, 1); // Все вершины изначально имеют степень 1
-    for (SizeType v : prufer_sequence)
+    if (n < 2)
+        return;
+    Index ptr = 0;
+    while (degree[ptr] != 1)
+        ++ptr;
+    Index leaf = ptr;
+    for (int code : prufer_sequence)
     {
-        degree.at(v)++;
-    }
-
-    // Мин-куча для хранения минимальных вершин
-    std::priority_queue<SizeType, std::vector<SizeType>, std::greater<SizeType>> min_heap;
-    for (int i = 1; i <= n; ++i)
-    {
-        if (degree.at(i) == 1)
-        { // Если вершина встречается только один раз
-            min_heap.push(i);
+        Index v = static_cast<Index>(code - 1);
+        placeEdge(leaf, v);
+        if (--degree[v] == 1 && v < ptr)
+        {
+            leaf = v; //< вершина стала листом и меньше всех непросмотренных листьев
+        }
+        else
+        {
+            do
+                ++ptr;
+            while (degree[ptr] != 1);
+            leaf = ptr;
         }
     }
+    placeEdge(leaf, static_cast<Index>(n - 1));
+}
 
-    // Восстанавливаем дерево
-    for (int i = 0; i < n - 2; ++i)
+/**
+ * Степени вершин дерева по последовательности Прюфера: вершина встречается в ней (степень - 1) раз
+ * @param prufer_sequence Последовательность Прюфера (вершины нумеруются с 1)
+ * @param n Количество вершин в дереве
+ * @param[out] degree степени вершин (нумерация с 0)
+ * @throw std::out_of_range если в последовательности есть несуществующая вершина
+ */
+template <class Index>
+void prufer_degrees(const List<int> &prufer_sequence, int n, List<Index> &degree)
+{
+    degree.assign(n, 1); // Все вершины изначально имеют степень 1
+    for (int v : prufer_sequence)
     {
-        SizeType v = min_heap.top();
-        min_heap.pop();
-
-        SizeType u = prufer_sequence.at(i);
-
-        // Добавляем ребро, гарантируя порядок (меньшее число первым)
-        edges.emplace_back(EdgeType{std::min(u, v), std::max(u, v)});
-
-        // Уменьшаем степень вершины
-        if (--degree.at(u) == 1)
-        {
-            min_heap.push(u);
-        }
+        if (v < 1 || v > n)
+            throw std::out_of_range("prufer code references missing vertex");
+        ++degree[v - 1];
     }
+}
 
-    // Добавляем последнее ребро
-    SizeType v1 = min_heap.top();
-    min_heap.pop();
-    SizeType v2 = min_heap.top();
+/**
+ * Функция для восстановления дерева из последовательности Прюфера
+ * Оптимизированная реализация
+ * @param prufer_sequence Последовательность Прюфера
+ * @param n Количество вершин в дереве
+ * @tparam Index тип номера вершины
+ * @return Вектор пар, представляющий дерево (меньшая вершина первой, нумерация с 0)
+ * @complexity O(n)
+ * @time O(n)
+ * @space O(n)
+ */
+template <class Index = SizeType>
+List<BasicEdge<Index>> prufer_unpack(const std::vector<int> &prufer_sequence, int n)
+{
+    List<BasicEdge<Index>> edges;
+    edges.reserve(n > 0 ? n - 1 : 0);
 
-    edges.emplace_back(EdgeType{std::min(v1, v2), std::max(v1, v2)});
-    for (auto& edge : edges)
+    List<Index> degree;
+    prufer_degrees(prufer_sequence, n, degree);
+    prufer_decode(prufer_sequence, n, degree, [&edges](Index u, Index v)
     {
-        --edge.first;
-        --edge.second;
-    }
+        // Добавляем ребро, гарантируя порядок (меньшее число первым)
+        edges.push_back(BasicEdge<Index>{std::min(u, v), std::max(u, v)});
+    });
     return edges;
 }
 
+/**
+ * Восстанавливает дерево из последовательности Прюфера сразу в граф CSR
+ *
+ * @details
+ *      Степени вершин известны заранее (по числу вхождений в последовательность), поэтому
+ *      смещения списков смежности вычисляются до распаковки, и каждое ребро записывается
+ *      прямо на своё место в графе, без промежуточного списка рёбер.
+ *
+ * @param prufer_sequence Последовательность Прюфера
+ * @param n Количество вершин в дереве
+ * @param[out] graph дерево (списки смежности отсортированы)
+ * @param degree рабочий массив степеней
+ * @complexity O(n)
+ */
+template <class Index>
+void prufer_unpack(const std::vector<int> &prufer_sequence, int n, BasicCsrGraph<Index> &graph, List<Index> &degree)
+{
+    prufer_degrees(prufer_sequence, n, degree);
+    graph.startBuild(degree);
+    prufer_decode(prufer_sequence, n, degree, [&graph](Index u, Index v)
+    {
+        graph.placeEdge(u, v);
+    });
+    graph.finishBuild();
+}
+
+// То же с временным массивом степеней
+template <class Index>
+void prufer_unpack(const std::vector<int> &prufer_sequence, int n, BasicCsrGraph<Index> &graph)
+{
+    List<Index> degree;
+    prufer_unpack(prufer_sequence, n, graph, degree);
+}
+
 #endif // PRUFER_H
\ No newline at end of file
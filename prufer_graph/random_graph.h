@@ -3,10 +3,11 @@
 #define RANDOM_GRAPH_H
 
 #include <algorithm>
+#include <limits>
 
 #include "common/common.h"
 #include "common/service.h"
-#include "graph/node.h"
+#include "graph/csr.h"
 #include "graph/edge.h"
 
 /**
@@ -103,91 +104,66 @@ std::vector<EdgeType> generate_new_pairs(
 }
 */
 // Модификация без отображения ребер в числа. Работа выполняется сразу над парами чисел.
-// Также исключены некоторые промежуточные копирования.
-// Предполагается, что небольшие изменения в используемых типах позволят ускорить работу без увеличения расхода памяти.
-void generate_new_pairs_unpacked(int n, List<EdgeType>& existing_pairs, double density)
+// Новые пары выбираются последовательной выборкой по пространству номеров пар (samplePairs):
+// кандидаты не перечисляются, выбранные пары дописываются в existing_pairs по возрастанию.
+template <class Index>
+void generate_new_pairs_unpacked(int n, List<BasicEdge<Index>>& existing_pairs, double density, Randomizer& rand)
 {
-    // using Clock = std::chrono::steady_clock;
-
-    // std::cerr << "starting edges generating\n";
-    // Clock::time_point begin = Clock::now();
-
-    int T = n * (n - 1) / 2; // Общее количество возможных пар
-
-    // Используем Set для быстрого поиска
-    Set<EdgeType> existing_set(existing_pairs.begin(), existing_pairs.end());
+    uint64_t T = static_cast<uint64_t>(n) * (n - 1) / 2; // Общее количество возможных пар
 
     // Определяем l — сколько новых пар нужно добавить
-    std::random_device rd;
-    std::mt19937 gen(rd());
-
     if (density > 1 || density < 0)
         throw std::invalid_argument("Некорректная плотность");
 
-    int l = int(double(T) * density);
+    uint64_t l = static_cast<uint64_t>(double(T) * density);
 
     if (l == 0)
     {
-        std::uniform_int_distribution<int> dist(0, T - existing_pairs.size());
-        l = dist(gen);
+        uint64_t free = T - existing_pairs.size();
+        // число свободных пар перестаёт помещаться в int уже при n ~ 65536
+        l = free <= static_cast<uint64_t>(std::numeric_limits<int>::max())
+            ? rand.rand(0, static_cast<int>(free))
+            : static_cast<uint64_t>(rand.uniform() * double(free + 1));
     }
 
-    if (l - n <= 0)
+    if (l <= static_cast<uint64_t>(n))
         return;
-    
-    //l = l - n;
 
-    // Генерация списка доступных индексов (не входящих в existing_pairs)
-    List<EdgeType> available_indices;
-    available_indices.reserve(T - existing_pairs.size());
-
-    for (SizeType i = 0; i < n - 1; i++)
-        for (SizeType j = i + 1; j < n; ++j) // <- генерируем упорядоченные пары с пропуском петель
-        {
-            EdgeType pair{i, j};
-            if (existing_set.count(pair) == 0)
-                available_indices.push_back(std::move(pair));
-        }
-    // std::cout << "l to generate l = " << l << std::endl;
-    // Выбор l случайных индексов с помощью std::sample
-    // вставляем сразу в existing_pairs
-    std::sample(available_indices.begin(), available_indices.end(), std::back_inserter(existing_pairs), l, gen);
-
-    // Clock::time_point end = Clock::now();
-    // std::cerr << "Time difference = " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << "[mcs] = "
-    //           << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1'000'000.0 << " sec" << '\n';
+    // Существующие пары -- запрещённые для выбора, нужны в нормализованном отсортированном виде
+    List<BasicEdge<Index>> exclude;
+    exclude.reserve(existing_pairs.size());
+    for (const auto& pair : existing_pairs)
+        exclude.push_back(normalizeEdge(pair.first, pair.second));
+    std::sort(exclude.begin(), exclude.end());
+    exclude.erase(std::unique(exclude.begin(), exclude.end()), exclude.end());
+
+    l = std::min<uint64_t>(l, T - exclude.size());
+    existing_pairs.reserve(existing_pairs.size() + l);
+    samplePairs(static_cast<Index>(n), exclude, l, rand, [&](Index a, Index b)
+    {
+        existing_pairs.push_back(BasicEdge<Index>{a, b});
+    });
 }
 
 /**
- * Функция для преобразования списка ребер в список узлов
+ * Функция для преобразования списка ребер в граф в формате CSR
  * @param edges список ребер
  * @param n количество вершин
- * @return список узлов
+ * @return граф со списками смежности, уложенными в один массив
  * @complexity O(n + m)
  * @time O(n + m)
  * @space O(n + m)
  */
-List<Node> transform(const List<EdgeType>& edges, int n)
+template <class Index>
+BasicCsrGraph<Index> transform(const List<BasicEdge<Index>>& edges, int n)
 {
     // using Clock = std::chrono::steady_clock;
     // Clock::time_point begin = Clock::now();
 
     // std::cout << "transformation init \n";
 
-    // Создаём список узлов с предвыделенной памятью
-    List<Node> nodes;
-    nodes.reserve(n);
-
-    // Заполняем его нодами
-    for (int i = 0; i < n; ++i)
-        nodes.emplace_back(i, Set<SizeType>{});
-
-    // Добавляем рёбра напрямую в множества инцидентных вершин
-    for (const auto& edge : edges)
-    {
-        nodes[edge.first].incident.insert(edge.second);
-        nodes[edge.second].incident.insert(edge.first);
-    }
+    // Раскладываем рёбра по вершинам: подсчёт степеней и одна раскладка без хеш-таблиц
+    BasicCsrGraph<Index> graph(edges, static_cast<Index>(n));
 
     // Clock::time_point end = Clock::now();
     // std::cerr << "Time difference = " 
@@ -196,7 +172,7 @@ List<Node> transform(const List<EdgeType>& edges, int n)
     //          << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1'000'000.0 
     //          << " sec" << '\n';
 
-    return nodes;
+    return graph;
 }
 
 #
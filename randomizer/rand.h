@@ -4,33 +4,160 @@
 
 #include <random>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 
 #include "common/common.h"
 
+/**
+ * Генератор случайных чисел со счётчиком (Philox4x32-10).
+ *
+ * @details
+ *      Каждое 128-битное слово выхода -- это шифрование номера блока ключом seed, поэтому генератор
+ *      не имеет состояния, кроме счётчика: создание стоит несколько присваиваний, а не
+ *      системный вызов и заполнение 2.5 КБ состояния std::mt19937.
+ *
+ *      Независимые потоки чисел задаются номером потока stream (старшая половина счётчика).
+ *      Номер потока строится из координат единицы работы (плотность, граф, поиск) функцией
+ *      streamId, так что результат не зависит от того, в каком порядке и каким потоком
+ *      выполнения обрабатывались задачи: одинаковый seed даёт побитово одинаковый эксперимент.
+ *
+ *      Удовлетворяет требованиям UniformRandomBitGenerator, но для воспроизводимости на разных
+ *      стандартных библиотеках ограниченные величины строятся собственными методами.
+ */
 class Randomizer
 {
     public:
-    Randomizer() : rng(std::random_device()())
+    using result_type = uint32_t;
+
+    /**
+     * @param seed главная затравка эксперимента
+     * @param stream номер независимого потока чисел
+     */
+    Randomizer(uint64_t seed, uint64_t stream = 0)
+        : m_key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+          m_stream(stream)
     {}
 
+    // Номер потока по координатам единицы работы (перемешивание splitmix64)
+    static uint64_t streamId(uint64_t first, uint64_t second = 0, uint64_t third = 0)
+    {
+        uint64_t id = mix(first);
+        id = mix(id ^ second);
+        return mix(id ^ third);
+    }
+
+    // Затравка из системного источника энтропии (для запусков без явно заданного seed)
+    static uint64_t randomSeed()
+    {
+        std::random_device device;
+        return (static_cast<uint64_t>(device()) << 32) | device();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    // Следующие 32 случайных бита
+    result_type operator()()
+    {
+        if (m_used == 4)
+            refill();
+        return m_block[m_used++];
+    }
+
+    // Следующие 64 случайных бита
+    uint64_t next64()
+    {
+        uint64_t high = (*this)();
+        return (high << 32) | (*this)();
+    }
+
+    // Равномерное вещественное число из интервала (0, 1): 0 и 1 не выпадают, поэтому от него можно брать логарифм
+    double uniform()
+    {
+        return (static_cast<double>(next64() >> 11) + 0.5) * 0x1.0p-53;
+    }
+
+    // Равномерное число из [0, bound) без смещения (метод Лемира)
+    uint32_t below(uint32_t bound)
+    {
+        uint64_t product = static_cast<uint64_t>((*this)()) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound)
+        {
+            uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+            while (low < threshold)
+            {
+                product = static_cast<uint64_t>((*this)()) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
     int rand(int min, int max)
     {
-        std::uniform_int_distribution<int> dist(min, max);
-        return dist(rng);
+        return min + static_cast<int>(below(static_cast<uint32_t>(max - min) + 1));
     }
 
-    SizeType uRand(SizeType min, SizeType max)
+    // Номер вершины из [min, max] (подходит для любого типа номера вершины)
+    uint32_t uRand(uint32_t min, uint32_t max)
     {
-        std::uniform_int_distribution<std::mt19937::result_type> dist(min, max);
-        return dist(rng);
+        return min + below(max - min + 1);
     }
 
     template<class T>
     void shuffle(List<T>& target)
-        { std::shuffle(target.begin(), target.end(), rng); }
+    {
+        // Фишер-Йетс на собственном ограниченном генераторе
+        for (std::size_t i = target.size(); i > 1; --i)
+            std::swap(target[i - 1], target[below(static_cast<uint32_t>(i))]);
+    }
 
     private:
-	std::mt19937 rng; 
+    static uint64_t mix(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo)
+    {
+        uint64_t product = static_cast<uint64_t>(a) * b;
+        hi = static_cast<uint32_t>(product >> 32);
+        lo = static_cast<uint32_t>(product);
+    }
+
+    // Очередной блок: 10 раундов Philox над счётчиком (номер блока, номер потока)
+    void refill()
+    {
+        uint32_t ctr[4] = {static_cast<uint32_t>(m_counter), static_cast<uint32_t>(m_counter >> 32),
+                           static_cast<uint32_t>(m_stream), static_cast<uint32_t>(m_stream >> 32)};
+        uint32_t key[2] = {m_key[0], m_key[1]};
+        for (int round = 0; round < 10; ++round)
+        {
+            uint32_t hi0, lo0, hi1, lo1;
+            mulhilo(0xD2511F53u, ctr[0], hi0, lo0);
+            mulhilo(0xCD9E8D57u, ctr[2], hi1, lo1);
+            ctr[0] = hi1 ^ ctr[1] ^ key[0];
+            ctr[1] = lo1;
+            ctr[2] = hi0 ^ ctr[3] ^ key[1];
+            ctr[3] = lo0;
+            key[0] += 0x9E3779B9u;
+            key[1] += 0xBB67AE85u;
+        }
+        std::copy(ctr, ctr + 4, m_block);
+        ++m_counter;
+        m_used = 0;
+    }
+
+    uint32_t m_key[2];        // Затравка эксперимента
+    uint64_t m_stream;        // Номер потока
+    uint64_t m_counter = 0;   // Номер следующего блока в потоке
+    uint32_t m_block[4] = {};
+    int m_used = 4;           // Сколько слов текущего блока уже выдано
 };
 
-#endif // RAND_H
\ No newline at end of file
+#endif // RAND_H
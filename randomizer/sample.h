@@ -0,0 +1,156 @@
+#pragma once
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include "randomizer/rand.h"
+
+/**
+ * Последовательная выборка без возвращения (алгоритмы A и D Виттера).
+ *
+ * @details
+ *      Выбирает count различных индексов из [0, population) и выдаёт их по возрастанию,
+ *      не храня ни генеральную совокупность, ни саму выборку: для очередного индекса
+ *      разыгрывается только длина пропуска до него. Каждое из C(population, count)
+ *      подмножеств равновероятно.
+ *
+ *      Алгоритм D тратит O(1) ожидаемых операций на выбранный индекс; когда доля выбираемых
+ *      элементов становится велика (population <= 13 * count), дешевле алгоритм A,
+ *      который перебирает пропуски по одному -- это тоже O(count).
+ *
+ * @param population размер совокупности
+ * @param count сколько индексов выбрать (не больше population)
+ * @param rand генератор случайных чисел
+ * @param visit вызывается для каждого выбранного индекса: visit(uint64_t index)
+ * @throw std::invalid_argument если count > population
+ * @complexity O(count) ожидаемо
+ * @space O(1)
+ */
+template<class Visitor>
+void sampleSorted(uint64_t population, uint64_t count, Randomizer& rand, Visitor&& visit)
+{
+    if (count > population)
+        throw std::invalid_argument("sample is larger than population");
+
+    uint64_t current = 0;     // Первый индекс, который ещё можно выбрать
+    uint64_t n = count;       // Сколько осталось выбрать
+    uint64_t N = population;  // Сколько осталось кандидатов
+    auto select = [&](uint64_t skip)
+    {
+        if (skip >= N) // защита от ошибок округления в вещественной арифметике
+            skip = N - 1;
+        visit(current + skip);
+        current += skip + 1;
+        N -= skip + 1;
+        --n;
+    };
+
+    if (n == N)
+    {
+        while (n > 0)
+            select(0);
+        return;
+    }
+
+    // Алгоритм D: пропуск разыгрывается методом отбора с мажорантой
+    constexpr uint64_t alphaInv = 13;
+    if (n > 1 && n * alphaInv < N)
+    {
+        double nReal = static_cast<double>(n);
+        double nInv = 1.0 / nReal;
+        double NReal = static_cast<double>(N);
+        double vPrime = std::exp(std::log(rand.uniform()) * nInv);
+        uint64_t qu1 = N - n + 1;
+        double qu1Real = NReal - nReal + 1;
+        uint64_t threshold = alphaInv * n;
+        while (n > 1 && threshold < N)
+        {
+            double nMin1Inv = 1.0 / (nReal - 1);
+            uint64_t skip;
+            while (true)
+            {
+                double x;
+                while (true)
+                {
+                    x = NReal * (1 - vPrime);
+                    skip = static_cast<uint64_t>(x);
+                    if (skip < qu1)
+                        break;
+                    vPrime = std::exp(std::log(rand.uniform()) * nInv);
+                }
+                double u = rand.uniform();
+                double negSkip = -static_cast<double>(skip);
+                double y1 = std::exp(std::log(u * NReal / qu1Real) * nMin1Inv);
+                vPrime = y1 * (1 - x / NReal) * (qu1Real / (negSkip + qu1Real));
+                if (vPrime <= 1)
+                    break; // быстрая проверка пройдена
+
+                double y2 = 1;
+                double top = NReal - 1;
+                double bottom;
+                uint64_t limit;
+                if (n - 1 > skip)
+                {
+                    bottom = NReal - nReal;
+                    limit = N - skip;
+                }
+                else
+                {
+                    bottom = NReal + negSkip - 1;
+                    limit = qu1;
+                }
+                for (uint64_t t = N - 1; t >= limit; --t)
+                {
+                    y2 = (y2 * top) / bottom;
+                    --top;
+                    --bottom;
+                }
+                if (NReal / (NReal - x) >= y1 * std::exp(std::log(y2) * nMin1Inv))
+                {
+                    vPrime = std::exp(std::log(rand.uniform()) * nMin1Inv);
+                    break; // точная проверка пройдена
+                }
+                vPrime = std::exp(std::log(rand.uniform()) * nInv);
+            }
+
+            select(skip);
+            NReal -= static_cast<double>(skip) + 1;
+            nReal -= 1;
+            nInv = nMin1Inv;
+            qu1 -= skip;
+            qu1Real -= static_cast<double>(skip);
+            threshold -= alphaInv;
+        }
+        if (n == 1)
+        {
+            select(static_cast<uint64_t>(static_cast<double>(N) * vPrime));
+            return;
+        }
+    }
+
+    // Алгоритм A: вероятность пропустить очередного кандидата считается напрямую
+    double NReal = static_cast<double>(N);
+    double top = static_cast<double>(N - n);
+    while (n >= 2)
+    {
+        double v = rand.uniform();
+        uint64_t skip = 0;
+        double quot = top / NReal;
+        while (quot > v)
+        {
+            ++skip;
+            --top;
+            --NReal;
+            quot = quot * top / NReal;
+        }
+        select(skip);
+        --NReal;
+    }
+    if (n == 1)
+        select(static_cast<uint64_t>(static_cast<double>(N) * rand.uniform()));
+}
+
+#endif // SAMPLE_H
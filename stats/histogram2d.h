@@ -0,0 +1,69 @@
+#pragma once
+#ifndef HISTOGRAM2D_H
+#define HISTOGRAM2D_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "common/common.h"
+
+/**
+ * Двумерная гистограмма с фиксированными корзинами (например, расстояние x число посещённых вершин).
+ *
+ * @details
+ *      Ось делится на bins корзин одинаковой ширины ceil(limit / bins), значения за пределом
+ *      попадают в последнюю корзину. Гистограммы одной формы сливаются сложением счётчиков.
+ */
+class Histogram2D
+{
+public:
+    Histogram2D() = default;
+
+    /**
+     * @param xBins, yBins число корзин по осям
+     * @param xLimit, yLimit верхние границы осей (значения из [0, limit) распределяются равномерно)
+     */
+    Histogram2D(std::size_t xBins, uint64_t xLimit, std::size_t yBins, uint64_t yLimit)
+        : m_xBins(xBins), m_yBins(yBins),
+          m_xWidth(std::max<uint64_t>(1, (xLimit + xBins - 1) / xBins)),
+          m_yWidth(std::max<uint64_t>(1, (yLimit + yBins - 1) / yBins)),
+          m_counts(xBins * yBins, 0)
+    {}
+
+    void add(uint64_t x, uint64_t y, uint64_t count = 1)
+    {
+        std::size_t i = std::min<uint64_t>(x / m_xWidth, m_xBins - 1);
+        std::size_t j = std::min<uint64_t>(y / m_yWidth, m_yBins - 1);
+        m_counts[i * m_yBins + j] += count;
+    }
+
+    // Сливает гистограмму той же формы; std::invalid_argument, если формы различаются
+    void merge(const Histogram2D& other)
+    {
+        if (other.m_xBins != m_xBins || other.m_yBins != m_yBins || other.m_xWidth != m_xWidth
+            || other.m_yWidth != m_yWidth)
+            throw std::invalid_argument("histograms of different shape cannot be merged");
+        for (std::size_t k = 0; k < m_counts.size(); ++k)
+            m_counts[k] += other.m_counts[k];
+    }
+
+    std::size_t xBins() const { return m_xBins; }
+    std::size_t yBins() const { return m_yBins; }
+    uint64_t xWidth() const { return m_xWidth; }
+    uint64_t yWidth() const { return m_yWidth; }
+
+    // Счётчики по строкам: корзина (i, j) -- counts()[i * yBins() + j]
+    List<uint64_t>& counts() { return m_counts; }
+    const List<uint64_t>& counts() const { return m_counts; }
+
+private:
+    std::size_t m_xBins = 0;
+    std::size_t m_yBins = 0;
+    uint64_t m_xWidth = 1;
+    uint64_t m_yWidth = 1;
+    List<uint64_t> m_counts;
+};
+
+#endif // HISTOGRAM2D_H
@@ -0,0 +1,114 @@
+#include "phase_profile.h"
+
+#include <chrono>
+#include <ostream>
+
+#include "stats/scoped_timer.h"
+
+double profile_clock::nsPerTick()
+{
+    static const double value = []
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point begin = Clock::now();
+        uint64_t firstTick = now();
+        while (Clock::now() - begin < std::chrono::milliseconds(10))
+            ;
+        uint64_t lastTick = now();
+        double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+        return lastTick > firstTick ? elapsed / double(lastTick - firstTick) : 1.0;
+#else
+        return 1.0;
+#endif
+    }();
+    return value;
+}
+
+PhaseProfile::PhaseProfile()
+    : m_nsPerTick(profile_clock::nsPerTick())
+{}
+
+void PhaseProfile::merge(const PhaseProfile& other)
+{
+    for (int phase = 0; phase < kPhaseCount; ++phase)
+    {
+        m_phases[phase].time.merge(other.m_phases[phase].time);
+        m_phases[phase].latency.merge(other.m_phases[phase].latency);
+    }
+    for (int counter = 0; counter < kCounterCount; ++counter)
+        m_counters[counter] += other.m_counters[counter];
+}
+
+const RunningStats& PhaseProfile::time(ProfilePhase phase) const
+{
+    return m_phases[phase].time;
+}
+
+const QuantileSketch& PhaseProfile::latency(ProfilePhase phase) const
+{
+    return m_phases[phase].latency;
+}
+
+uint64_t PhaseProfile::counter(ProfileCounter counter) const
+{
+    return m_counters[counter];
+}
+
+const char* PhaseProfile::phaseName(ProfilePhase phase)
+{
+    static const char* const names[kPhaseCount] = {"tree", "densify", "snapshot", "all_pairs", "bfs", "dfs", "bibfs", "msbfs",
+                                                   "order_cache", "path", "log"};
+    return names[phase];
+}
+
+const char* PhaseProfile::counterName(ProfileCounter counter)
+{
+    static const char* const names[kCounterCount] = {"graphs", "edges", "searches", "failed"};
+    return names[counter];
+}
+
+void PhaseProfile::writeCsvHeader(std::ostream& out)
+{
+    out << "thread,density,kind,name,count,total_ms,mean_us,p50_us,p99_us,max_us\n";
+}
+
+void PhaseProfile::writeCsv(std::ostream& out, const std::string& thread, double density) const
+{
+    for (int i = 0; i < kPhaseCount; ++i)
+    {
+        const PhaseData& phase = m_phases[i];
+        if (phase.time.count == 0)
+            continue;
+        out << thread << ',' << density << ",phase," << phaseName(ProfilePhase(i)) << ',' << phase.time.count
+            << ',' << phase.time.mean * phase.time.count / 1e6 << ',' << phase.time.mean / 1e3 << ','
+            << phase.latency.quantile(0.5) / 1e3 << ',' << phase.latency.quantile(0.99) / 1e3 << ','
+            << phase.time.max / 1e3 << '\n';
+    }
+    for (int i = 0; i < kCounterCount; ++i)
+        out << thread << ',' << density << ",counter," << counterName(ProfileCounter(i)) << ',' << m_counters[i]
+            << ",,,,,\n";
+}
+
+void PhaseProfile::writeJson(std::ostream& out, const std::string& thread, double density) const
+{
+    out << "{\"thread\": \"" << thread << "\", \"density\": " << density << ", \"phases\": {";
+    bool first = true;
+    for (int i = 0; i < kPhaseCount; ++i)
+    {
+        const PhaseData& phase = m_phases[i];
+        if (phase.time.count == 0)
+            continue;
+        out << (first ? "" : ", ") << '"' << phaseName(ProfilePhase(i)) << "\": {\"count\": " << phase.time.count
+            << ", \"total_ms\": " << phase.time.mean * phase.time.count / 1e6
+            << ", \"mean_us\": " << phase.time.mean / 1e3
+            << ", \"p50_us\": " << phase.latency.quantile(0.5) / 1e3
+            << ", \"p99_us\": " << phase.latency.quantile(0.99) / 1e3
+            << ", \"max_us\": " << phase.time.max / 1e3 << '}';
+        first = false;
+    }
+    out << "}, \"counters\": {";
+    for (int i = 0; i < kCounterCount; ++i)
+        out << (i == 0 ? "" : ", ") << '"' << counterName(ProfileCounter(i)) << "\": " << m_counters[i];
+    out << "}}";
+}
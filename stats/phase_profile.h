@@ -0,0 +1,98 @@
+#pragma once
+#ifndef PHASE_PROFILE_H
+#define PHASE_PROFILE_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include "common/common.h"
+#include "stats/quantile_sketch.h"
+#include "stats/running_stats.h"
+
+// Замеряемые этапы эксперимента
+enum ProfilePhase
+{
+    kPhaseTree,       // Генерация и распаковка кода Прюфера
+    kPhaseDensify,    // Достройка дерева до плотности (или построение дополнения)
+    kPhaseSnapshot,   // Чтение или запись снимка графа
+    kPhaseAllPairs,   // Распределение расстояний между всеми парами
+    kPhaseBfs,        // Один поиск в ширину
+    kPhaseDfs,        // Один поиск в глубину
+    kPhaseBiBfs,      // Один двунаправленный поиск
+    kPhaseMsBfs,      // Пачка поисков MS-BFS
+    kPhaseOrderCache, // Полный обход из начальной вершины группы поисков
+    kPhasePath,       // Восстановление длины пути по предкам
+    kPhaseLog,        // Запись результатов графа (лог, файл результатов, сводки)
+    kPhaseCount
+};
+
+// Счётчики событий
+enum ProfileCounter
+{
+    kCounterGraphs,      // Построенные графы
+    kCounterEdges,       // Рёбра в хранимом представлении (для плотных графов -- удалённые)
+    kCounterSearches,    // Выполненные поиски (по одному на пару концов)
+    kCounterFailed,      // Поиски, завершившиеся ошибкой
+    kCounterCount
+};
+
+/**
+ * Профиль этапов одного потока для одной плотности.
+ *
+ * @details
+ *      Для каждого этапа хранятся число замеров, среднее и крайние значения длительности
+ *      (RunningStats) и эскиз квантилей (QuantileSketch, 1%), из которого берутся p50 и p99.
+ *      Длительности хранятся в наносекундах. Профили сливаются, поэтому итог по плотности
+ *      собирается из профилей потоков.
+ */
+class PhaseProfile
+{
+public:
+    PhaseProfile();
+
+    // Замер длительностью ticks тиков profile_clock
+    void record(ProfilePhase phase, uint64_t ticks)
+    {
+        double ns = ticks * m_nsPerTick;
+        m_phases[phase].time.add(ns);
+        m_phases[phase].latency.add(ns);
+    }
+
+    void count(ProfileCounter counter, uint64_t value = 1)
+    {
+        m_counters[counter] += value;
+    }
+
+    void merge(const PhaseProfile& other);
+
+    const RunningStats& time(ProfilePhase phase) const;
+    const QuantileSketch& latency(ProfilePhase phase) const;
+    uint64_t counter(ProfileCounter counter) const;
+
+    static const char* phaseName(ProfilePhase phase);
+    static const char* counterName(ProfileCounter counter);
+
+    /**
+     * Строки CSV по этапам и счётчикам: thread,density,kind,name,count,total_ms,mean_us,p50_us,p99_us,max_us
+     * (для счётчиков заполнено только count)
+     */
+    static void writeCsvHeader(std::ostream& out);
+    void writeCsv(std::ostream& out, const std::string& thread, double density) const;
+
+    // Объект JSON {"thread": .., "density": .., "phases": {..}, "counters": {..}}
+    void writeJson(std::ostream& out, const std::string& thread, double density) const;
+
+private:
+    struct PhaseData
+    {
+        RunningStats time;
+        QuantileSketch latency;
+    };
+
+    double m_nsPerTick;
+    PhaseData m_phases[kPhaseCount];
+    uint64_t m_counters[kCounterCount] = {};
+};
+
+#endif // PHASE_PROFILE_H
@@ -0,0 +1,113 @@
+#include "quantile_sketch.h"
+
+#include <cmath>
+#include <stdexcept>
+
+QuantileSketch::QuantileSketch(double alpha)
+    : m_alpha(alpha), m_gamma((1 + alpha) / (1 - alpha)), m_logGamma(std::log(m_gamma))
+{
+    if (!(alpha > 0 && alpha < 1))
+        throw std::invalid_argument("sketch accuracy must be in (0, 1)");
+}
+
+int QuantileSketch::index(double value) const
+{
+    return static_cast<int>(std::ceil(std::log(value) / m_logGamma));
+}
+
+void QuantileSketch::cover(int i)
+{
+    if (m_bins.empty())
+    {
+        m_offset = i;
+        m_bins.assign(1, 0);
+        return;
+    }
+    if (i < m_offset)
+    {
+        m_bins.insert(m_bins.begin(), m_offset - i, 0);
+        m_offset = i;
+    }
+    else if (i >= m_offset + static_cast<int>(m_bins.size()))
+        m_bins.resize(i - m_offset + 1, 0);
+}
+
+void QuantileSketch::add(double value, uint64_t count)
+{
+    m_count += count;
+    if (value <= 0)
+    {
+        m_zeroCount += count;
+        return;
+    }
+    int i = index(value);
+    cover(i);
+    m_bins[i - m_offset] += count;
+}
+
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+    if (other.m_alpha != m_alpha)
+        throw std::invalid_argument("sketches with different accuracy cannot be merged");
+    m_count += other.m_count;
+    m_zeroCount += other.m_zeroCount;
+    if (other.m_bins.empty())
+        return;
+    cover(other.m_offset);
+    cover(other.m_offset + static_cast<int>(other.m_bins.size()) - 1);
+    for (std::size_t k = 0; k < other.m_bins.size(); ++k)
+        m_bins[other.m_offset - m_offset + k] += other.m_bins[k];
+}
+
+double QuantileSketch::quantile(double q) const
+{
+    if (m_count == 0)
+        return 0;
+    // номер значения (с нуля) в отсортированном потоке
+    uint64_t rank = static_cast<uint64_t>(q * (m_count - 1));
+    if (rank < m_zeroCount)
+        return 0;
+    uint64_t seen = m_zeroCount;
+    for (std::size_t k = 0; k < m_bins.size(); ++k)
+    {
+        seen += m_bins[k];
+        if (seen > rank)
+            return 2 * std::pow(m_gamma, m_offset + static_cast<int>(k)) / (m_gamma + 1);
+    }
+    return 2 * std::pow(m_gamma, m_offset + static_cast<int>(m_bins.size()) - 1) / (m_gamma + 1);
+}
+
+uint64_t QuantileSketch::count() const
+{
+    return m_count;
+}
+
+double QuantileSketch::alpha() const
+{
+    return m_alpha;
+}
+
+uint64_t QuantileSketch::zeroCount() const
+{
+    return m_zeroCount;
+}
+
+int QuantileSketch::offset() const
+{
+    return m_offset;
+}
+
+const List<uint64_t>& QuantileSketch::bins() const
+{
+    return m_bins;
+}
+
+void QuantileSketch::restore(uint64_t zeroCount, int offset, const List<uint64_t>& bins)
+{
+    m_zeroCount = zeroCount;
+    m_offset = offset;
+    m_bins = bins;
+    m_count = zeroCount;
+    for (uint64_t bin : m_bins)
+        m_count += bin;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+/**
+ * Среднее и дисперсия потока значений за один проход (метод Уэлфорда).
+ *
+ * @details
+ *      Хранятся число значений, среднее и сумма квадратов отклонений от среднего (m2), поэтому
+ *      дисперсия не теряет точность, как при вычислении через сумму квадратов. Две сводки
+ *      объединяются формулой Чана, так что потоки и запуски можно считать независимо и сливать.
+ */
+struct RunningStats
+{
+    uint64_t count = 0;
+    double mean = 0;
+    double m2 = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    void add(double value)
+    {
+        ++count;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    void merge(const RunningStats& other)
+    {
+        if (other.count == 0)
+            return;
+        if (count == 0)
+        {
+            *this = other;
+            return;
+        }
+        uint64_t total = count + other.count;
+        double delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / total);
+        count = total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    // Несмещённая выборочная дисперсия
+    double variance() const
+    {
+        return count > 1 ? m2 / (count - 1) : 0;
+    }
+};
+
+#endif // RUNNING_STATS_H
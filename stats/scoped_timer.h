@@ -0,0 +1,86 @@
+#pragma once
+#ifndef SCOPED_TIMER_H
+#define SCOPED_TIMER_H
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "stats/phase_profile.h"
+
+// Замеры этапов (PROFILE_SCOPE, PROFILE_COUNT); при сборке с -DENABLE_PROFILE=0 макросы пустые
+#ifndef ENABLE_PROFILE
+#define ENABLE_PROFILE 1
+#endif
+
+namespace profile_clock
+{
+
+/**
+ * Текущее время в тиках: счётчик тактов процессора (TSC) на x86, иначе steady_clock в наносекундах.
+ *
+ * @details
+ *      Чтение TSC стоит единицы наносекунд и не требует системного вызова. Современные процессоры
+ *      держат TSC неизменной частоты и согласованным между ядрами, поэтому тики разных потоков
+ *      сравнимы; в наносекунды они переводятся множителем nsPerTick.
+ */
+inline uint64_t now()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Наносекунд в одном тике (калибруется по steady_clock один раз за запуск, около 10 мс)
+double nsPerTick();
+
+} // namespace profile_clock
+
+/**
+ * Замер времени от создания до разрушения: длительность записывается в этап phase профиля.
+ * При profile == nullptr (замеры выключены во время запуска) часы не читаются.
+ */
+class ScopedTimer
+{
+public:
+    ScopedTimer(PhaseProfile* profile, ProfilePhase phase)
+        : m_profile(profile), m_phase(phase), m_start(profile != nullptr ? profile_clock::now() : 0)
+    {}
+
+    ~ScopedTimer()
+    {
+        if (m_profile != nullptr)
+            m_profile->record(m_phase, profile_clock::now() - m_start);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    PhaseProfile* m_profile;
+    ProfilePhase m_phase;
+    uint64_t m_start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if ENABLE_PROFILE
+// Замер до конца текущего блока
+#define PROFILE_SCOPE(profile, phase) ScopedTimer PROFILE_CONCAT(profileScope, __LINE__)((profile), (phase))
+// Добавляет value к счётчику профиля (если он задан)
+#define PROFILE_COUNT(profile, counter, value) \
+    do { if ((profile) != nullptr) (profile)->count((counter), (value)); } while (false)
+#else
+// Аргументы не вычисляются (sizeof), но считаются использованными: без предупреждений о неиспользуемых параметрах
+#define PROFILE_SCOPE(profile, phase) ((void)sizeof(profile))
+#define PROFILE_COUNT(profile, counter, value) ((void)sizeof(profile), (void)sizeof(value))
+#endif
+
+#endif // SCOPED_TIMER_H
@@ -0,0 +1,183 @@
+#include "search_stats.h"
+
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+SearchStats::SearchStats(const List<std::string>& methods, uint32_t numVertices)
+    : m_methods(methods), m_numVertices(numVertices), m_moments(methods.size() + 1),
+      m_sketches(methods.size() + 1)
+{
+    // расстояние меньше n, посещённых вершин не больше n
+    for (std::size_t i = 0; i < methods.size(); ++i)
+        m_heatmaps.emplace_back(kHeatmapBins, numVertices, kHeatmapBins, numVertices + 1);
+}
+
+void SearchStats::add(int dist, const List<int>& visited)
+{
+    m_moments[0].add(dist);
+    m_sketches[0].add(dist);
+    for (std::size_t i = 0; i < m_methods.size(); ++i)
+    {
+        m_moments[i + 1].add(visited[i]);
+        m_sketches[i + 1].add(visited[i]);
+        m_heatmaps[i].add(dist, visited[i]);
+    }
+}
+
+void SearchStats::merge(const SearchStats& other)
+{
+    if (other.m_methods != m_methods || other.m_numVertices != m_numVertices)
+        throw std::invalid_argument("stats of different experiments cannot be merged");
+    for (std::size_t c = 0; c < m_moments.size(); ++c)
+    {
+        m_moments[c].merge(other.m_moments[c]);
+        m_sketches[c].merge(other.m_sketches[c]);
+    }
+    for (std::size_t i = 0; i < m_heatmaps.size(); ++i)
+        m_heatmaps[i].merge(other.m_heatmaps[i]);
+}
+
+uint64_t SearchStats::searches() const
+{
+    return m_moments.empty() ? 0 : m_moments[0].count;
+}
+
+uint32_t SearchStats::numVertices() const
+{
+    return m_numVertices;
+}
+
+const List<std::string>& SearchStats::methods() const
+{
+    return m_methods;
+}
+
+const RunningStats& SearchStats::moments(std::size_t column) const
+{
+    return m_moments[column];
+}
+
+const QuantileSketch& SearchStats::sketch(std::size_t column) const
+{
+    return m_sketches[column];
+}
+
+std::string SearchStats::columnName(std::size_t column) const
+{
+    return column == 0 ? "dist" : m_methods[column - 1];
+}
+
+const Histogram2D& SearchStats::heatmap(std::size_t method) const
+{
+    return m_heatmaps[method];
+}
+
+void SearchStats::write(std::ostream& out, double density) const
+{
+    auto precision = out.precision(std::numeric_limits<double>::max_digits10);
+    out << "density " << density << " n " << m_numVertices << " methods " << m_methods.size();
+    for (const auto& method : m_methods)
+        out << ' ' << method;
+    out << '\n';
+
+    for (std::size_t c = 0; c < m_moments.size(); ++c)
+    {
+        const RunningStats& moments = m_moments[c];
+        // у пустой сводки минимум и максимум бесконечны -- пишем нули
+        out << "moments " << columnName(c) << ' ' << moments.count << ' ' << moments.mean << ' ' << moments.m2
+            << ' ' << (moments.count ? moments.min : 0) << ' ' << (moments.count ? moments.max : 0) << '\n';
+    }
+    for (std::size_t c = 0; c < m_sketches.size(); ++c)
+    {
+        const QuantileSketch& sketch = m_sketches[c];
+        out << "sketch " << columnName(c) << ' ' << sketch.alpha() << ' ' << sketch.zeroCount() << ' '
+            << sketch.offset() << ' ' << sketch.bins().size();
+        for (uint64_t bin : sketch.bins())
+            out << ' ' << bin;
+        out << '\n';
+    }
+    for (std::size_t i = 0; i < m_heatmaps.size(); ++i)
+    {
+        const Histogram2D& heatmap = m_heatmaps[i];
+        out << "heatmap " << m_methods[i] << ' ' << heatmap.xBins() << ' ' << heatmap.xWidth() << ' '
+            << heatmap.yBins() << ' ' << heatmap.yWidth();
+        for (uint64_t count : heatmap.counts())
+            out << ' ' << count;
+        out << '\n';
+    }
+    out << "end\n";
+    out.precision(precision);
+}
+
+void expectWord(std::istream& in, const std::string& expected, const std::string& format)
+{
+    std::string word;
+    if (!(in >> word) || word != expected)
+        throw std::runtime_error("malformed " + format + ": expected '" + expected + "'");
+}
+
+bool SearchStats::read(std::istream& in, double& density, SearchStats& stats)
+{
+    std::string word;
+    if (!(in >> word))
+        return false;
+    if (word != "density")
+        throw std::runtime_error("malformed stats: expected 'density'");
+
+    std::size_t count;
+    uint32_t numVertices;
+    in >> density;
+    expectWord(in, "n");
+    in >> numVertices;
+    expectWord(in, "methods");
+    in >> count;
+    List<std::string> methods(count);
+    for (auto& method : methods)
+        in >> method;
+    if (!in)
+        throw std::runtime_error("malformed stats header");
+    stats = SearchStats(methods, numVertices);
+
+    for (std::size_t c = 0; c < stats.m_moments.size(); ++c)
+    {
+        expectWord(in, "moments");
+        expectWord(in, stats.columnName(c));
+        RunningStats& moments = stats.m_moments[c];
+        in >> moments.count >> moments.mean >> moments.m2 >> moments.min >> moments.max;
+        if (moments.count == 0)
+            moments = RunningStats();
+    }
+    for (std::size_t c = 0; c < stats.m_sketches.size(); ++c)
+    {
+        expectWord(in, "sketch");
+        expectWord(in, stats.columnName(c));
+        double alpha;
+        uint64_t zero;
+        int offset;
+        std::size_t bins;
+        in >> alpha >> zero >> offset >> bins;
+        List<uint64_t> counts(bins);
+        for (auto& bin : counts)
+            in >> bin;
+        stats.m_sketches[c] = QuantileSketch(alpha);
+        stats.m_sketches[c].restore(zero, offset, counts);
+    }
+    for (std::size_t i = 0; i < stats.m_heatmaps.size(); ++i)
+    {
+        expectWord(in, "heatmap");
+        expectWord(in, methods[i]);
+        std::size_t xBins, yBins;
+        uint64_t xWidth, yWidth;
+        in >> xBins >> xWidth >> yBins >> yWidth;
+        Histogram2D heatmap(xBins, xBins * xWidth, yBins, yBins * yWidth);
+        for (auto& value : heatmap.counts())
+            in >> value;
+        stats.m_heatmaps[i] = heatmap;
+    }
+    expectWord(in, "end");
+    if (!in)
+        throw std::runtime_error("malformed stats body");
+    return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include "common/common.h"
+#include "stats/histogram2d.h"
+#include "stats/quantile_sketch.h"
+#include "stats/running_stats.h"
+
+/**
+ * Сводка поисков на графах одной плотности, собираемая по ходу эксперимента.
+ *
+ * @details
+ *      Для расстояния и для числа посещённых вершин каждым методом поиска хранятся среднее и
+ *      дисперсия (RunningStats) и эскиз квантилей (QuantileSketch); для каждого метода --
+ *      тепловая карта "расстояние x посещённые вершины" (Histogram2D). Все части сливаемы,
+ *      поэтому сводки потоков, задач или отдельных запусков объединяются методом merge.
+ *
+ *      Текстовый формат (одна сводка):
+ *          density <d> n <n> methods <k> <имя_1> ... <имя_k>
+ *          moments <имя> <count> <mean> <m2> <min> <max>               -- для dist и каждого метода
+ *          sketch <имя> <alpha> <zero> <offset> <bins> <счётчики...>   -- для dist и каждого метода
+ *          heatmap <имя> <xBins> <xWidth> <yBins> <yWidth> <счётчики...> -- для каждого метода
+ *          end
+ */
+class SearchStats
+{
+public:
+    static constexpr std::size_t kHeatmapBins = 64; // Корзин по каждой оси тепловой карты
+
+    SearchStats() = default;
+
+    /**
+     * @param methods имена методов поиска (столбцы посещённых вершин)
+     * @param numVertices число вершин графов: задаёт границы осей тепловых карт
+     */
+    SearchStats(const List<std::string>& methods, uint32_t numVertices);
+
+    // Результат одного поиска: расстояние и число посещённых вершин каждым методом (в порядке methods)
+    void add(int dist, const List<int>& visited);
+
+    // Сливает сводку с теми же методами и числом вершин; std::invalid_argument, если они различаются
+    void merge(const SearchStats& other);
+
+    uint64_t searches() const;
+    uint32_t numVertices() const;
+    const List<std::string>& methods() const;
+
+    // Столбец 0 -- расстояние, столбец 1 + i -- метод i
+    const RunningStats& moments(std::size_t column) const;
+    const QuantileSketch& sketch(std::size_t column) const;
+    std::string columnName(std::size_t column) const;
+
+    // Тепловая карта метода i
+    const Histogram2D& heatmap(std::size_t method) const;
+
+    void write(std::ostream& out, double density) const;
+
+    /**
+     * Читает очередную сводку
+     *
+     * @return false, если сводок в потоке больше нет
+     * @throw std::runtime_error при нарушении формата
+     */
+    static bool read(std::istream& in, double& density, SearchStats& stats);
+
+private:
+    List<std::string> m_methods;
+    uint32_t m_numVertices = 0;
+    List<RunningStats> m_moments;
+    List<QuantileSketch> m_sketches;
+    List<Histogram2D> m_heatmaps;
+};
+
+/**
+ * Следующее слово потока должно совпасть с expected (разбор текстовых форматов: сводок, контрольных точек)
+ *
+ * @param format название формата для сообщения об ошибке
+ * @throw std::runtime_error если слово другое или поток кончился
+ */
+void expectWord(std::istream& in, const std::string& expected, const std::string& format = "stats");
+
+#endif // SEARCH_STATS_H